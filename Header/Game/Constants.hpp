@@ -3,7 +3,6 @@
 #include <cstddef>
 
 // Game logic constants
-extern const size_t MAX_PASSENGERS;
 extern const float START_TRACK_T;        // Starting position on track
 extern const float END_TRACK_T;          // End position (loop completion)
 extern const float MAX_START_VELOCITY;   // Cruise speed threshold
@@ -11,3 +10,7 @@ extern const float START_ACCELERATION;   // Chain lift acceleration
 extern const float SLOWDOWN_DECELERATION;
 extern const float REVERSE_VELOCITY;
 extern const float COOLDOWN_DURATION;
+
+// Simulation clock
+extern const float SIM_TIMESTEP;         // Fixed simulation step (seconds)
+extern const float MAX_FRAME_TIME;       // Longest frame the simulation catches up on
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Constants.hpp"
+
+// Game logic tuning that can change at run time (parameter sweeps)
+// Defaults are the constants from Constants.cpp
+struct RideConfig {
+    float startTrackT = START_TRACK_T;                  // Station position on track
+    float endTrackT = END_TRACK_T;                      // Lap marker: the loop completes here, just before the station
+    float maxStartVelocity = MAX_START_VELOCITY;        // Takeoff ends at this speed
+    float slowdownDeceleration = SLOWDOWN_DECELERATION; // Deceleration when sick
+    float reverseVelocity = REVERSE_VELOCITY;           // Speed back to the station (negative)
+    float cooldownDuration = COOLDOWN_DURATION;         // Seconds to wait before reverse
+    int seats = 0;                                      // Seats riders may take, 0 for every seat of the train
+    bool verbose = true;                                // Print state changes and passenger actions
+};
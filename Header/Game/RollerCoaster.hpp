@@ -1,41 +1,61 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include "GameState.hpp"
 #include "Person.hpp"
+#include "RideConfig.hpp"
+#include "../wagonstate.hpp"
 
-class Wagon;
 class TrackPath;
 
 class RollerCoaster {
 private:
-    Wagon& wagon;
+    WagonState& wagon;
     const TrackPath& trackPath;
+    RideConfig config;
     GameState gameState;
     float cooldownTimer;
-    bool passedMidpoint;  // Track loop detection
-    std::vector<Person> passengers;
+
+    // Passengers by seat: seats[i] is only valid while bit i of occupied is set
+    // Seats past seatCount in the last word stay set, so they never look free
+    int seatCount;
+    std::vector<Person> seats;
+    std::vector<uint64_t> occupied;
+    size_t passengerCount;
+    size_t buckledCount;
 
     bool allPassengersBuckled() const;
     bool hasPassengers() const;
     int findFirstEmptySeat() const;
     Person* findPassengerBySeat(int seatIndex);
     const Person* findPassengerBySeat(int seatIndex) const;
+    float travelledFromStart() const;  // Fraction of the track ahead of the station, wrapped to [0, 1)
+    void handleRideEvent(WagonState::RideEvent event);
+    void returnToStation();  // REVERSE: drive the wagon to the station the short way
+    void arriveAtStation();  // Park the wagon at the station and unbuckle everyone
 
 public:
-    RollerCoaster(Wagon& wagon, const TrackPath& trackPath);
+    RollerCoaster(WagonState& wagon, const TrackPath& trackPath, const RideConfig& config = RideConfig());
 
+    // Reacts to the wagon's events from the last simulation step, so call it before WagonState::updatePhysics
     void update(float deltaTime);
 
     // Input handlers
     void handleAddPassenger();         // SPACE key
-    void handleSeatAction(int index);  // Keys 1-8 (0-indexed internally)
+    void handleSeatAction(int index);  // Keys 1-8 (0-indexed internally) for the first eight seats
     void handleStartRide();            // ENTER key
 
     // Queries
     GameState getState() const;
     size_t getPassengerCount() const;
-    const std::vector<Person>& getPassengers() const;
+    int getSeatCount() const { return seatCount; }
+    static int seatCapacity(const RideConfig& config, int carCount);   // getSeatCount() for a train of carCount
     bool isSeatOccupied(int seatIndex) const;
+    int nextPassengerSeat(int seatIndex) const;  // First occupied seat from seatIndex on, -1 if none
     const Person* getPassengerBySeat(int seatIndex) const;  // Public accessor for camera passenger check
+    const RideConfig& getConfig() const { return config; }
+
+    // Chain the game state into seed (session record/replay checks)
+    uint64_t hashState(uint64_t seed) const;
 };
@@ -0,0 +1,105 @@
+#ifndef BLOCKSYSTEM_HPP
+#define BLOCKSYSTEM_HPP
+
+#include "trainsystem.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class TrackPath;
+
+// One block section, as an arc-length range in world units
+// Blocks tile the track: each one ends where the next begins, and the last one may run past
+// the end of the track and end at the first one's begin plus the track length
+struct TrackBlock
+{
+    float begin;
+    float end;
+};
+
+struct BlockParams
+{
+    float trainLength = 14.0f;          // World units from the head of a train to its tail
+    float brakeDeceleration = 16.0f;    // World units per second squared (4 m/s^2 at 0.25 m per unit)
+    float safetyMargin = 2.0f;          // Trains stop this far before the end of their last block
+};
+
+// Block-section safety system for the trains of a TrainSystem
+// Every train holds a run of consecutive blocks, from the one under its tail to the last one it
+// has claimed ahead. Before its braking distance reaches past that run it claims the next block;
+// if another train holds it, the train brakes (BRAKING) and waits at the boundary (HOLDING) until
+// the block clears, then starts again. Occupancy is one bit per block, claimed and released with
+// atomic operations, so trains can be updated from several threads at once.
+class BlockSystem
+{
+public:
+    BlockSystem();
+
+    // Install the block layout; returns false if the blocks do not tile the track
+    bool setBlocks(const std::vector<TrackBlock>& layout, float trackLength);
+    const std::vector<TrackBlock>& getBlocks() const { return blocks; }
+    size_t blockCount() const { return blocks.size(); }
+
+    // count blocks of equal length, the first starting at the beginning of the track
+    static std::vector<TrackBlock> evenBlocks(float trackLength, size_t count);
+
+    BlockParams& getParams() { return params; }
+    const BlockParams& getParams() const { return params; }
+
+    // Clear all occupancy and claim the blocks under every train at its current position
+    // Returns false if two trains share a block; update() does nothing until a reset succeeds
+    bool reset(TrainSystem& trains, const TrackPath& path);
+
+    // Release the blocks trains have left, claim the blocks ahead and set BRAKING and HOLDING
+    // Call once per tick before TrainSystem::step, after reset() for the same trains
+    void update(TrainSystem& trains, const TrackPath& path, float deltaTime, bool parallel = true);
+
+    bool isOccupied(size_t block) const;
+    size_t occupiedCount() const;
+
+    // Trains that were found inside a block they did not hold and had to be stopped at its boundary
+    uint64_t getEmergencyStops() const { return emergencyStops.load(std::memory_order_relaxed); }
+
+private:
+    // Block containing the given distance along the track
+    uint32_t blockAt(float distance) const;
+    uint32_t blockNear(uint32_t hint, float distance) const;  // Searches forward from hint first
+
+    // Blocks from a forward to b, wrapping around the track
+    uint32_t blocksAhead(uint32_t a, uint32_t b) const;
+    uint32_t nextBlock(uint32_t b) const { return b + 1 == blocks.size() ? 0 : b + 1; }
+    uint32_t previousBlock(uint32_t b) const { return b == 0 ? static_cast<uint32_t>(blocks.size()) - 1 : b - 1; }
+
+    // Set the block's bit; fails if it was already set
+    bool claim(uint32_t block);
+    void release(uint32_t block);
+
+    void updateRange(TrainSystem& trains, float trackLength, float deltaTime, size_t begin, size_t end);
+
+    // Stop train i on the spot with its head at the given distance
+    void emergencyStop(TrainSystem& trains, size_t i, float head, float trackLength);
+
+    std::vector<TrackBlock> blocks;
+    float trackLength;
+    BlockParams params;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> occupancy;  // One bit per block
+    size_t occupancyWords;
+    bool ready;  // Set by a successful reset()
+
+    // Per train: the run of blocks it holds, tail first
+    std::vector<uint32_t> tailBlock;
+    std::vector<uint32_t> lastBlock;
+
+    std::atomic<uint64_t> emergencyStops;
+};
+
+// Time the block update against the train step for growing numbers of trains on one track,
+// with blocks and braking scaled to the train spacing so the trains keep moving, and print the
+// overhead per tick and how many trains were still moving
+void benchmarkBlockSystem(const TrackPath& path);
+
+#endif
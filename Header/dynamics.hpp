@@ -0,0 +1,95 @@
+#ifndef DYNAMICS_HPP
+#define DYNAMICS_HPP
+
+#include <vector>
+
+class TrackPath;
+
+// Section of track that drives the train toward a target speed
+// Lifts (chain or tyre drives) only push, brakes only slow the train down
+struct TrackZone
+{
+    enum class Type
+    {
+        LIFT,
+        BRAKE
+    };
+
+    Type type;
+    float begin;        // Arc length in metres where the zone starts
+    float end;          // ... and ends (may wrap past the end of the track)
+    float targetSpeed;  // m/s
+    float maxForce;     // N
+};
+
+// Physical parameters of a train on the track (SI units)
+struct TrainDynamicsParams
+{
+    float metresPerUnit = 0.25f;        // Size of one world unit
+    float mass = 2600.0f;               // kg per car, riders included
+    int carCount = 1;                   // Cars coupled behind the lead car
+    float carSpacing = 3.75f;           // Metres between car centers along the track
+    float gravity = 9.81f;              // m/s^2
+    float airDensity = 1.225f;          // kg/m^3
+    float dragArea = 1.5f;              // Drag coefficient times frontal area, m^2
+    float rollingResistance = 0.003f;   // Rolling resistance coefficient
+    float chainForce = 40000.0f;        // N, strongest pull of the station chain
+    float speedResponse = 0.5f;         // Seconds for lifts and brakes to close a speed error
+    std::vector<TrackZone> zones;
+};
+
+// Position and speed of a train along the track
+struct DynamicsState
+{
+    double distance;    // Arc length of the lead car in metres [0, track length)
+    float speed;        // m/s along the track direction (negative rolls backwards)
+    double work;        // J done on the train by drag, rolling resistance, lifts and brakes
+    float chainSpeed;   // m/s the station chain pulls toward, 0 when it is off
+};
+
+// Train dynamics along the center line: gravity along the arc-length tangent, aerodynamic drag,
+// rolling resistance, lift and brake forces. The cars are rigidly coupled, so gravity acts on the
+// slope averaged over all of them. Integrated with classic RK4 in arc length; each step costs four
+// constant-time tangent lookups per car.
+class TrainDynamics
+{
+public:
+    explicit TrainDynamics(const TrainDynamicsParams& params = TrainDynamicsParams());
+
+    const TrainDynamicsParams& getParams() const { return params; }
+    TrainDynamicsParams& getParams() { return params; }
+
+    // Track length in metres
+    float getTrackLength(const TrackPath& path) const;
+
+    // Acceleration along the track (m/s^2) and power of the non-conservative forces (W)
+    void derivatives(const TrackPath& path, double distance, float speed, float chainSpeed,
+                     float& acceleration, float& power) const;
+
+    // Advance the state by dt seconds
+    void step(const TrackPath& path, DynamicsState& state, float dt) const;
+
+    // Kinetic plus potential energy minus the work of the non-conservative forces (J)
+    // Constant along a run up to integration error, which makes it a check on the integrator
+    double totalEnergy(const TrackPath& path, const DynamicsState& state) const;
+
+    // Replace the zones with the ride's: a lift on the longest climb of the track, pulling at
+    // liftSpeed, and a brake run of BRAKE_RUN metres ending at the lap marker, slowing to
+    // brakeSpeed. Positions are track fractions and speeds track lengths per second, as in WagonState
+    void setRideZones(const TrackPath& path, float lapEndT, float liftSpeed, float brakeSpeed);
+
+    static constexpr float LIFT_MIN_SLOPE = 0.15f;      // Sine of the pitch that counts as climbing
+    static constexpr float BRAKE_RUN = 40.0f;           // Metres
+    static constexpr float BRAKE_DECELERATION = 4.0f;   // m/s^2 at full brake force
+
+private:
+    // Wrap an arc length into [0, length)
+    static double wrapDistance(double distance, double length);
+
+    // Whether an arc length lies in a zone, including zones that wrap past the end of the track
+    static bool inZone(const TrackZone& zone, double distance);
+
+    TrainDynamicsParams params;
+};
+
+#endif
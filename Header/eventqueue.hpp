@@ -0,0 +1,52 @@
+#ifndef EVENTQUEUE_HPP
+#define EVENTQUEUE_HPP
+
+#include <cstddef>
+
+// Fixed-capacity FIFO for events raised and handled on the same thread
+// The storage is part of the object, so pushing never allocates. When the queue is full, push
+// drops the event and returns false; size the capacity for what one tick can raise.
+template <typename T, size_t Capacity>
+class EventQueue
+{
+public:
+    EventQueue() : head(0), count(0) {}
+
+    bool push(const T& event)
+    {
+        if (count == Capacity)
+        {
+            return false;
+        }
+        items[(head + count) % Capacity] = event;
+        ++count;
+        return true;
+    }
+
+    // Oldest event first; returns false when the queue is empty
+    bool pop(T& event)
+    {
+        if (count == 0)
+        {
+            return false;
+        }
+        event = items[head];
+        head = (head + 1) % Capacity;
+        --count;
+        return true;
+    }
+
+    // i-th oldest event, without removing it
+    const T& at(size_t i) const { return items[(head + i) % Capacity]; }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void clear() { head = 0; count = 0; }
+
+private:
+    T items[Capacity];
+    size_t head;
+    size_t count;
+};
+
+#endif
@@ -32,19 +32,33 @@ public:
     std::vector<unsigned int> indices;
     std::vector<Texture>      textures;
     unsigned int VAO;
+    unsigned int indexCount;
 
-    // constructor
+    // constructors only take the data; upload() creates the GL objects, so meshes can be built off the GL thread
     Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures);
 
+    // for geometry that lives elsewhere (a cooked model file) and stays valid until upload()
+    Mesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount, std::vector<Texture> textures);
+
+    // creates the buffer objects; frees the CPU copy of the geometry unless keepGeometry
+    void upload(bool keepGeometry = false);
+
     // render the mesh
     void Draw(Shader& shader);
 
+    size_t getVertexCount() const { return vertexCount; }
+
 private:
     // render data
     unsigned int VBO, EBO;
 
+    // geometry held elsewhere until upload, null when it is in vertices and indices
+    const Vertex* externalVertices;
+    const unsigned int* externalIndices;
+    size_t vertexCount;
+
     // initializes all the buffer objects/arrays
-    void setupMesh();
+    void setupMesh(const Vertex* vertexData, const unsigned int* indexData);
 };
 
 #endif
@@ -0,0 +1,74 @@
+#ifndef MESHCACHE_HPP
+#define MESHCACHE_HPP
+
+#include "mappedfile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cooked model file (.rcmesh): the meshes of an imported model in the exact layout Mesh uploads to GL
+// Vertices are interleaved position, normal and texture coordinates (8 floats, the Vertex struct),
+// indices are 32-bit. A cooked file stays valid while the source file keeps the size and modification
+// time recorded in it; otherwise the model is imported again and recooked.
+class CookedModel
+{
+public:
+    static constexpr size_t VERTEX_SIZE = 8 * sizeof(float);
+
+    struct TextureRef
+    {
+        std::string type;   // Sampler name prefix, as in Texture::type
+        std::string path;   // Relative to the model's directory
+    };
+
+    // One mesh to cook, pointing at the caller's data
+    struct MeshSource
+    {
+        const void* vertices;
+        uint32_t vertexCount;
+        const uint32_t* indices;
+        uint32_t indexCount;
+        std::vector<TextureRef> textures;
+    };
+
+    // One cooked mesh, pointing into the mapped file
+    struct MeshView
+    {
+        const void* vertices;
+        uint32_t vertexCount;
+        const uint32_t* indices;
+        uint32_t indexCount;
+        std::vector<TextureRef> textures;
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    // res/person1/model_mesh.obj -> res/person1/model_mesh.rcmesh
+    static std::string cachePathFor(const std::string& sourcePath);
+
+    // Write the cooked file for sourcePath; returns false if it could not be written
+    static bool write(const std::string& cachePath, const std::string& sourcePath, const std::vector<MeshSource>& meshes);
+
+    // Map a cooked file that is up to date with sourcePath; returns false if it is missing, stale or damaged
+    bool open(const std::string& cachePath, const std::string& sourcePath);
+    void close();
+
+    size_t getMeshCount() const { return meshes.size(); }
+    const MeshView& getMesh(size_t index) const { return meshes[index]; }
+
+    // Bounds over all meshes
+    const float* getBoundsMin() const { return boundsMin; }
+    const float* getBoundsMax() const { return boundsMax; }
+
+    size_t getFileSize() const { return file.size(); }
+
+private:
+    MappedFile file;
+    std::vector<MeshView> meshes;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+#endif
@@ -10,11 +10,17 @@
 #include "mesh.hpp"
 #include "shader.hpp"
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 unsigned int TextureFromFile(const char* path, const std::string& directory, bool gamma = false);
 
+class CookedModel;
+class ResourceManager;
+struct TextureResource;
+
 class Model
 {
 public:
@@ -23,16 +29,53 @@ public:
     std::vector<Mesh>    meshes;
     std::string directory;
     bool gammaCorrection;
+    bool cooked;    // loaded from the cooked .rcmesh next to the source file
+    bool uploaded;
+
+    // empty model, filled in two stages by load() and upload()
+    Model();
+
+    // constructor, expects a filepath to a 3D model. Loads and uploads it in one go.
+    // keepGeometry keeps the vertices and indices of every mesh on the CPU side; otherwise they are freed after upload
+    Model(std::string const& path, bool gamma = false, bool keepGeometry = false);
+    ~Model();
+
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+
+    // CPU stage, safe on any thread: reads the cooked file (or imports and cooks the model) and decodes its textures.
+    // The meshes have their data but no GL objects until upload(); with keepGeometry they keep it afterwards too.
+    // With resources the textures come from the resource manager, shared with every other model that uses them.
+    bool load(std::string const& path, bool keepGeometry = false, ResourceManager* resources = nullptr);
+
+    // GL stage, on the thread that owns the GL context: creates the buffers and textures of everything load() read.
+    // Does nothing once the model is uploaded
+    void upload();
 
-    // constructor, expects a filepath to a 3D model.
-    Model(std::string const& path, bool gamma = false);
+    // resident bytes of the meshes: buffers on the GPU, and geometry kept or waiting for upload on the CPU
+    // (textures are counted with the texture resources)
+    size_t getGpuBytes() const;
+    size_t getCpuBytes() const;
 
     // draws the model, and thus all its meshes
     void Draw(Shader& shader);
 
 private:
-    // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
-    void loadModel(std::string const& path);
+    bool keepGeometry;
+
+    // cooked file the meshes point into until they are uploaded
+    std::unique_ptr<CookedModel> cookedFile;
+
+    // texture resources of textures_loaded, by index, and their index by path
+    std::vector<std::shared_ptr<TextureResource>> textureResources;
+    std::unordered_map<std::string, size_t> textureIndex;
+    ResourceManager* resources;     // during load() only
+
+    // creates the meshes from a cooked model file, copying the geometry only when it is kept
+    void loadCooked(const CookedModel& cookedModel);
+
+    // writes the imported meshes to the cooked model file
+    void cook(std::string const& path, std::string const& cachePath) const;
 
     // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
     void processNode(aiNode* node, const aiScene* scene);
@@ -42,6 +85,9 @@ private:
     // checks all material textures of a given type and loads the textures if they're not loaded yet.
     // the required info is returned as a Texture struct.
     std::vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName);
+
+    // returns the texture at path (relative to the model's directory), decoding it on first use; its id is set by upload()
+    Texture loadTexture(const std::string& path, const std::string& typeName);
 };
 
 #endif
@@ -0,0 +1,14 @@
+#ifndef OBJLOADER_HPP
+#define OBJLOADER_HPP
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+// Positions-only Wavefront OBJ reader for builds without Assimp or GL
+// Faces are fan-triangulated and every triangle corner gets its own vertex, in file order,
+// which is the layout Model gets from Assimp with aiProcess_Triangulate for a single-object file.
+// meanEdgeLength receives the mean triangle edge length (0 without triangles).
+bool loadObjTriangles(const std::string& path, std::vector<glm::vec3>& corners, float& meanEdgeLength);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use for data-parallel loops
+// Queried once: hardware_concurrency() costs microseconds on some platforms, more than a small loop
+inline unsigned int workerCount()
+{
+    static const unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+    return count;
+}
+
+// Split [begin, end) into contiguous chunks and run fn(chunkBegin, chunkEnd) on each, one per
+// thread, returning once all are done. Ranges shorter than two chunks of minChunk run inline
+// on the calling thread, so small inputs pay no thread start-up cost.
+template <typename Fn>
+void parallelFor(size_t begin, size_t end, size_t minChunk, Fn fn)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    size_t count = end - begin;
+    size_t maxChunks = std::max<size_t>(1, count / std::max<size_t>(1, minChunk));
+    size_t numChunks = std::min<size_t>(workerCount(), maxChunks);
+    if (numChunks <= 1)
+    {
+        fn(begin, end);
+        return;
+    }
+
+    size_t chunkSize = (count + numChunks - 1) / numChunks;
+    std::vector<std::thread> threads;
+    threads.reserve(numChunks - 1);
+
+    // The calling thread takes the first chunk itself
+    for (size_t c = 1; c < numChunks; ++c)
+    {
+        size_t chunkBegin = begin + c * chunkSize;
+        size_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+        if (chunkBegin >= chunkEnd)
+        {
+            break;
+        }
+        threads.emplace_back([=]() { fn(chunkBegin, chunkEnd); });
+    }
+
+    fn(begin, std::min(end, begin + chunkSize));
+
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+}
+
+#endif
@@ -1,18 +1,22 @@
 #ifndef PASSENGER_HPP
 #define PASSENGER_HPP
 
+#include "resources.hpp"
+
 #include <string>
 #include <glm/glm.hpp>
 
-class Model;
 class Shader;
 class Wagon;
 
 class Passenger
 {
 public:
-    Passenger(const std::string& modelPath, int seatIndex);
-    ~Passenger();
+    // The model is shared with every passenger of the same person
+    Passenger(ModelHandle model, int seatIndex);
+
+    // Upload the model if no other passenger has, and take the shared seatbelt; needs the GL context
+    void init(ResourceManager& resources);
 
     void draw(Shader& shader, const Wagon& wagon);
 
@@ -28,17 +32,14 @@ public:
     void setSick(bool value) { sick = value; }
 
 private:
-    Model* model;
+    ModelHandle model;
     int seatIndex;
     bool buckled = false;
     bool sick = false;
 
-    // Seatbelt rendering
-    unsigned int seatbeltVAO = 0;
-    unsigned int seatbeltVBO = 0;
-    static unsigned int seatbeltTextureID;
-    static bool seatbeltTextureLoaded;
-    void setupSeatbeltMesh();
+    // Seatbelt rendering, shared by all passengers
+    GeometryHandle seatbelt;
+    TextureHandle seatbeltTexture;
     void drawSeatbelt(Shader& shader, const Wagon& wagon);
 
     // Tuning parameters
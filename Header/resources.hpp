@@ -0,0 +1,121 @@
+#ifndef RESOURCES_HPP
+#define RESOURCES_HPP
+
+#include "util.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Model;
+
+// How an image file becomes a texture; the same file with other settings is another texture
+struct TextureSettings
+{
+    bool flip = true;       // Upside down for OpenGL
+    bool repeat = false;    // Wrap instead of clamping
+    int channels = 4;       // Components per pixel, 0 for the file's own
+};
+
+// One texture, shared by everything that uses the same file with the same settings
+struct TextureResource
+{
+    std::string path;
+    TextureSettings settings;
+    unsigned int id = 0;        // 0 until uploaded
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    ImageData image;            // Decoded pixels, until upload
+
+    TextureResource() = default;
+    TextureResource(const TextureResource&) = delete;
+    TextureResource& operator=(const TextureResource&) = delete;
+    ~TextureResource();
+
+    // CPU stage, safe on any thread
+    bool decode(const std::string& file, const TextureSettings& textureSettings);
+
+    // GL stage: create the texture from the decoded pixels; does nothing once uploaded
+    void upload();
+
+    size_t getGpuBytes() const;     // With mipmaps
+    size_t getCpuBytes() const;
+};
+
+// Vertex array shared by everything drawn with the same shape (position, normal, uv per vertex)
+struct GeometryResource
+{
+    std::string name;
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    int vertexCount = 0;
+
+    GeometryResource() = default;
+    GeometryResource(const GeometryResource&) = delete;
+    GeometryResource& operator=(const GeometryResource&) = delete;
+    ~GeometryResource();
+
+    size_t getGpuBytes() const;
+};
+
+typedef std::shared_ptr<Model> ModelHandle;
+typedef std::shared_ptr<TextureResource> TextureHandle;
+typedef std::shared_ptr<GeometryResource> GeometryHandle;
+
+// Every model, texture and shared geometry the game loads, each loaded and uploaded once however many
+// objects use it. Assets are found by hashing their path (or name) and handed out as reference-counted
+// handles: an asset lives while anything holds a handle to it, and releaseUnused() drops the ones only
+// the manager still holds.
+// Loading is the CPU stage and safe on any thread; requests for an asset that another thread is loading
+// wait for that load and share its result. Uploading needs the GL context.
+class ResourceManager
+{
+public:
+    ResourceManager() = default;
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+
+    // Model with its meshes and textures loaded but not uploaded until Model::upload()
+    // Its textures come from this manager, so models that use the same image share it
+    // Both loads return null when the file can't be read; failures aren't kept, so a later request retries
+    ModelHandle loadModel(const std::string& path);
+
+    // Texture decoded but not uploaded until TextureResource::upload()
+    TextureHandle loadTexture(const std::string& path, const TextureSettings& settings = TextureSettings());
+
+    // Geometry created from vertices (8 floats each) on the first request for name; needs the GL context
+    GeometryHandle getGeometry(const std::string& name, const float* vertices, int vertexCount);
+
+    // Drop every asset no handle outside the manager refers to; returns how many were dropped
+    size_t releaseUnused();
+
+    // Resident bytes over all assets
+    size_t getGpuBytes() const;
+    size_t getCpuBytes() const;
+
+    // Every asset with its users and its resident GPU and CPU bytes
+    void printReport() const;
+
+private:
+    // An asset and the lock its first load holds
+    template <typename T>
+    struct Entry
+    {
+        std::mutex mutex;
+        std::shared_ptr<T> resource;
+    };
+
+    template <typename T>
+    std::shared_ptr<Entry<T>> findOrAdd(std::unordered_map<std::string, std::shared_ptr<Entry<T>>>& table, const std::string& key);
+
+    mutable std::mutex mutex;   // Guards the tables, not the assets
+    std::unordered_map<std::string, std::shared_ptr<Entry<Model>>> models;
+    std::unordered_map<std::string, std::shared_ptr<Entry<TextureResource>>> textures;
+    std::unordered_map<std::string, std::shared_ptr<Entry<GeometryResource>>> geometries;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef RINGBUFFER_HPP
+#define RINGBUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread
+// The capacity is rounded up to a power of two. Each side keeps a private copy of the other
+// side's index and only reloads it when the copy says the queue is full (or empty), so in the
+// common case a push or pop touches no cache line the other thread writes.
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(size_t capacity)
+        : head(0), tail(0), cachedTail(0), cachedHead(0)
+    {
+        size_t size = 1;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+        items.reset(new T[size]);
+        mask = size - 1;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    // Producer side; returns false without waiting when the queue is full
+    bool push(const T& item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail > mask)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail > mask)
+            {
+                return false;
+            }
+        }
+        items[h & mask] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; moves up to maxCount items into out and returns how many
+    size_t pop(T* out, size_t maxCount)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (cachedHead == t)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+        }
+        size_t count = cachedHead - t;
+        if (count > maxCount)
+        {
+            count = maxCount;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = items[(t + i) & mask];
+        }
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::unique_ptr<T[]> items;
+    size_t mask;
+
+    // Producer and consumer state on separate cache lines
+    alignas(64) std::atomic<size_t> head;   // Next slot to write
+    alignas(64) std::atomic<size_t> tail;   // Next slot to read
+    alignas(64) size_t cachedTail;          // Producer's copy of tail
+    alignas(64) size_t cachedHead;          // Consumer's copy of head
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef SESSION_HPP
+#define SESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class RollerCoaster;
+class Telemetry;
+class TrackPath;
+class TrainDynamics;
+class WagonState;
+
+// Inputs that reach the simulation, applied at the start of a tick
+enum class SessionCommand : uint8_t
+{
+    ADD_PASSENGER,
+    SEAT_ACTION,        // arg = seat index
+    START_RIDE,
+    TOGGLE_DYNAMICS,
+    VIEW                // Camera only: arg = camera mode, value = yaw and pitch; not part of the state
+};
+
+struct JournalEntry
+{
+    uint32_t tick;
+    SessionCommand command;
+    uint8_t reserved;
+    uint16_t arg;
+    float value[2];
+};
+
+// Everything needed to run a session again: the setup, the inputs by tick and the state hash after every tick
+struct SessionJournal
+{
+    uint64_t trackKey = 0;      // TrackPath cache key of the track the session ran on
+    uint32_t carCount = 1;
+    bool physical = false;      // Dynamics on at the first tick
+    std::vector<JournalEntry> entries;      // In tick order
+    std::vector<uint32_t> stateHashes;      // Indexed by tick
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+};
+
+// Drives RollerCoaster and the wagon in fixed ticks from queued inputs, so that a session depends only
+// on the inputs and the ticks they arrive on, not on frame timing. Records a journal while running live,
+// or feeds the inputs of a recorded journal back and checks every tick against its state hash.
+class Session
+{
+public:
+    // dynamics is the model TOGGLE_DYNAMICS switches the wagon to and from
+    Session(RollerCoaster& game, WagonState& wagon, const TrackPath& path, const TrainDynamics* dynamics);
+
+    void startRecording(uint64_t trackKey);
+
+    // Returns false if the journal was recorded with another track or train
+    // At the end of the journal the session reports the result and goes back to live input
+    bool startReplay(const SessionJournal& journal, uint64_t trackKey);
+
+    // Sample ride telemetry after every tick; nullptr turns it off
+    void setTelemetry(Telemetry* recorder) { telemetry = recorder; }
+
+    // Queue a live input for the next tick; ignored while replaying
+    void submit(SessionCommand command, uint16_t arg = 0, float value0 = 0.0f, float value1 = 0.0f);
+
+    // Apply this tick's inputs, then advance the game and the wagon by SIM_TIMESTEP
+    void tick();
+
+    uint32_t getTick() const { return currentTick; }
+    bool isRecording() const { return recording; }
+    bool isReplaying() const { return replaying; }
+
+    // Tick whose state first differed from the journal, or -1 while every tick matched
+    int64_t getFirstMismatch() const { return firstMismatch; }
+
+    // VIEW entries applied in the last tick, for the renderer to replay the camera
+    const std::vector<JournalEntry>& getViewCommands() const { return viewCommands; }
+
+    const SessionJournal& getJournal() const { return journal; }
+
+    // Hash of everything that decides how the session continues
+    uint64_t hashState() const;
+
+private:
+    void apply(const JournalEntry& entry);
+
+    RollerCoaster& game;
+    WagonState& wagon;
+    const TrackPath& path;
+    const TrainDynamics* dynamics;
+    Telemetry* telemetry;
+
+    SessionJournal journal;
+    std::vector<JournalEntry> pending;      // Live inputs for the next tick
+    std::vector<JournalEntry> viewCommands;
+    size_t nextEntry;                       // Replay position in journal.entries
+    uint32_t currentTick;
+    bool recording;
+    bool replaying;
+    int64_t firstMismatch;
+};
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef STATIONSIM_HPP
+#define STATIONSIM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class TrackPath;
+class WagonState;
+
+// Cycle times of one train, measured by running RollerCoaster on the real track
+struct RideTimings
+{
+    double rideTime;                    // Start (TAKEOFF) to back in the station (OFFBOARDING)
+    double sickWindow;                  // Time after the start during which a rider can report sick
+    std::vector<double> sickRideTime;   // Start to OFFBOARDING with a rider sick at
+                                        // sickWindow * i / (size - 1)
+};
+
+// Operating procedure and rider behaviour for the station
+// Times are in seconds; the per-rider times are lognormal with the given mean and coefficient of variation
+struct StationConfig
+{
+    double arrivalRate = 400.0;     // Riders per hour, Poisson arrivals; keep it below the capacity
+    int trains = 2;
+    int seatsPerTrain = 8;
+    double boardMean = 4.0;         // Walking in and sitting down, one rider at a time
+    double boardCv = 0.5;
+    double buckleMean = 6.0;        // Riders buckle in parallel; the slowest one holds the train
+    double buckleCv = 0.5;
+    double unloadMean = 2.5;        // Leaving the train, one rider at a time
+    double unloadCv = 0.5;
+    double sickProbability = 0.002; // Per rider and ride
+    double dispatchInterval = 30.0; // Shortest time between two departures
+    double hours = 1000.0;          // Simulated time per replication, after the warm-up
+    double warmupHours = 1.0;       // Discarded so every replication starts from a loaded station
+    uint64_t seed = 1;
+};
+
+// Results summed over all replications
+struct StationStats
+{
+    static constexpr size_t WAIT_BINS = 4 * 3600;  // One-second bins up to four hours, plus an overflow bin
+    static constexpr size_t QUEUE_BINS = 4096;     // Queue lengths, plus an overflow bin
+
+    double hours;
+    uint64_t arrivals;
+    uint64_t riders;                // Riders who finished a ride
+    uint64_t dispatches;
+    uint64_t sickRides;
+    double maxQueue;
+    double queueArea;               // Queue length integrated over time, rider-seconds
+    double capacity;                // Riders per hour with the queue never empty, set by run()
+
+    std::vector<uint64_t> waitHistogram;    // Riders by seconds waited before boarding
+    std::vector<double> queueHistogram;     // Seconds spent at each queue length
+
+    StationStats();
+    void merge(const StationStats& other);
+
+    double ridersPerHour() const { return hours > 0.0 ? riders / hours : 0.0; }
+    double arrivalsPerHour() const { return hours > 0.0 ? arrivals / hours : 0.0; }
+
+    // Riders arrive at least as fast as the trains can take them: the queue grows without bound
+    // and its percentiles only depend on how long the run was
+    bool unstable() const { return capacity > 0.0 && arrivalsPerHour() >= capacity; }
+
+    // Percentiles that land in the overflow bin are infinite
+    double waitPercentile(double p) const;      // Seconds, p in [0, 1]
+    double queuePercentile(double p) const;     // Time-weighted, in riders
+    double meanQueue() const;
+    uint64_t waitOverflow() const { return waitHistogram.back(); }      // Riders who waited WAIT_BINS s or more
+    double queueOverflow() const { return queueHistogram.back(); }      // Seconds with QUEUE_BINS or more queued
+};
+
+// Discrete-event model of the station: riders queue, trains take turns at the single platform and
+// cycle through the same GameState phases as RollerCoaster (OFFBOARDING, ONBOARDING, TAKEOFF/RIDE,
+// and SLOWDOWN/COOLDOWN/REVERSE when someone gets sick) with their ride times from RideTimings
+class StationSimulator
+{
+public:
+    StationSimulator(const StationConfig& config, const RideTimings& timings);
+
+    // Measure the ride cycle by running RollerCoaster with the wagon on the track,
+    // once without incidents and once per sick sample
+    static RideTimings calibrate(const TrackPath& path, WagonState& wagon, int sickSamples = 32);
+
+    // One replication with its own random stream
+    // Saturated runs keep the queue full to measure the capacity of the platform and trains
+    StationStats runReplication(uint64_t seed, bool saturated = false) const;
+
+    // Independent replications spread across threads, merged, plus as many saturated ones for the capacity
+    StationStats run(int replications) const;
+
+    static void printStats(const StationStats& stats);
+
+private:
+    // Start to OFFBOARDING for a ride where a rider reports sick at the given time after the start
+    double sickRideTime(double sickAt) const;
+
+    StationConfig config;
+    RideTimings timings;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+
+#include "wagonstate.hpp"
+#include "Game/RideConfig.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class TrackPath;
+
+// Tuning of one ride: the game logic and the arcade model
+struct SweepPoint
+{
+    RideConfig ride;
+    WagonState::ArcadeParams arcade;
+};
+
+// Evenly spaced values of one parameter, both ends included
+// Parameters are named after their constants in lower case: start_track_t, end_track_t, max_start_velocity,
+// slowdown_deceleration, reverse_velocity, cooldown_duration, chain_lift_accel, cruise_speed, gravity_effect,
+// friction, min_velocity, max_velocity
+struct SweepRange
+{
+    std::string name;
+    float from;
+    float to;
+    int steps;
+};
+
+// How every ride of the sweep is run
+struct SweepSettings
+{
+    float sickAfter = 0.0f;         // Seconds into the ride when the rider feels sick, 0 for never
+    double maxRideTime = 600.0;     // Rides that take longer are reported as not completed
+    float metresPerUnit = 0.25f;    // For the peak speed
+};
+
+struct SweepResult
+{
+    SweepPoint point;
+    double rideTime;    // Start until the train leaves the circuit: loop complete, or stopped after the sick signal
+    double cycleTime;   // Start until the train is back in the station (OFFBOARDING)
+    float peakSpeed;    // m/s
+    bool completed;     // Back in the station within maxRideTime
+};
+
+// Runs one headless ride for every combination of the parameter ranges, all independent of each other,
+// on a work-stealing pool. Every ride gets its own copy of the prototype wagon (car count and dynamics
+// model) and its own RollerCoaster; the track is shared read-only.
+class ParameterSweep
+{
+public:
+    ParameterSweep(const TrackPath& path, const WagonState& prototype, const SweepSettings& settings);
+
+    // Parse NAME=FROM:TO:STEPS; returns false if the text or the name is not valid
+    static bool parseRange(const std::string& text, SweepRange& range);
+
+    // Later ranges vary fastest; returns false for an unknown parameter
+    bool addRange(const SweepRange& range);
+
+    // Product of the step counts of all ranges
+    size_t getPointCount() const;
+
+    // The defaults with the swept parameters set for point index
+    SweepPoint getPoint(size_t index) const;
+
+    // Results in point order
+    std::vector<SweepResult> run(unsigned int threads);
+
+    // Tasks the last run took from another worker's deque
+    size_t getStealCount() const { return lastSteals; }
+
+    // One ride with a single rider, the way the station calibration rides
+    SweepResult runPoint(const SweepPoint& point) const;
+
+    // One row per result, with every parameter and the measurements as columns
+    static bool writeCsv(const std::string& path, const std::vector<SweepResult>& results);
+
+private:
+    const TrackPath& path;
+    const WagonState& prototype;
+    SweepSettings settings;
+    std::vector<SweepRange> ranges;
+    size_t lastSteals;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef TASKGRAPH_HPP
+#define TASKGRAPH_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class WorkStealingPool;
+
+// Tasks with dependencies, each run once
+// Worker tasks run on a WorkStealingPool. Main tasks run on the thread that calls run(), for work that
+// must stay there (anything touching the GL context); it picks them up as they become ready, while the
+// workers carry on. A task becomes ready when the last task it depends on has finished. Tasks can only
+// depend on tasks added before them, so the graph has no cycles.
+class TaskGraph
+{
+public:
+    typedef size_t TaskId;
+    typedef std::function<void()> Task;
+
+    enum class Affinity
+    {
+        WORKER,
+        MAIN
+    };
+
+    explicit TaskGraph(WorkStealingPool& pool);
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    TaskId add(const std::string& name, Affinity affinity, Task task, const std::vector<TaskId>& dependencies = {});
+
+    // Shorthands for add
+    TaskId addWorker(const std::string& name, Task task, const std::vector<TaskId>& dependencies = {})
+    {
+        return add(name, Affinity::WORKER, std::move(task), dependencies);
+    }
+    TaskId addMain(const std::string& name, Task task, const std::vector<TaskId>& dependencies = {})
+    {
+        return add(name, Affinity::MAIN, std::move(task), dependencies);
+    }
+
+    // Run every task, executing main tasks on this thread; returns when all have finished
+    // A graph runs once
+    void run();
+
+    size_t getTaskCount() const { return nodes.size(); }
+
+    // Wall time of the last run, and the time its tasks took summed by where they ran, in ms
+    double getElapsed() const { return elapsed; }
+    double getWorkerTime() const;
+    double getMainTime() const;
+
+    // Every task with its start and end relative to the start of the run, in start order
+    void printTimeline() const;
+
+private:
+    struct Node
+    {
+        std::string name;
+        Affinity affinity;
+        Task task;
+        std::vector<TaskId> dependents;
+        size_t waitingFor;      // Dependencies not finished yet
+        double start;           // ms since the run started
+        double end;
+    };
+
+    // Run a task and release the tasks waiting for it
+    void execute(TaskId id);
+    void release(TaskId id);
+
+    WorkStealingPool& pool;
+    std::vector<Node> nodes;
+
+    std::mutex mutex;
+    std::condition_variable wake;   // Main tasks ready, or everything finished
+    std::deque<TaskId> mainReady;
+    size_t finished;
+    std::chrono::steady_clock::time_point runStart;     // Task times are measured from here
+    double elapsed;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include "ringbuffer.hpp"
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TrackPath;
+class WagonState;
+
+// What the rider in one seat feels during one simulation tick
+// G-forces are the specific force (acceleration minus gravity) in g along the seat's axes, so a rider
+// at rest reads 1 g vertical; jerk is the rate of change of acceleration along the same axes in m/s^3
+// Acceleration is computed from the track rather than differenced positions: dv/dt along the tangent,
+// v^2 times the spline curvature toward the normal, and the rotation of the car frame acting on the
+// seat's offset from the center line. Both are reported through a critically damped two-pole
+// low-pass at FILTER_BANDWIDTH, the band ride acceleration limits are assessed in. The arcade model
+// sets the speed outright when it reverses or brakes: a step of dv m/s then reads as a pulse of at
+// most 2 pi FILTER_BANDWIDTH dv / e m/s^2 and (2 pi FILTER_BANDWIDTH)^2 dv m/s^3 of jerk
+struct TelemetrySample
+{
+    uint32_t tick;
+    uint16_t seat;
+    uint16_t reserved;
+    float speed;            // m/s
+    float gVertical;        // Along the seat's up axis, positive pushes the rider into the seat
+    float gLateral;         // Along the seat's right axis
+    float gLongitudinal;    // Along the seat's forward axis, positive pushes the rider back
+    float jerkVertical;
+    float jerkLateral;
+    float jerkLongitudinal;
+};
+
+// Per-seat ride telemetry
+// sample() runs on the simulation thread once per tick: it evaluates every seat's acceleration from
+// the track under its car and pushes the samples into a lock-free ring buffer.
+// A background thread drains the ring into column blocks and writes them to the file, so the
+// simulation never waits on the disk. When the ring is full, samples are dropped and counted,
+// unless the recorder was started to wait for the writer (for runs faster than real time).
+class Telemetry
+{
+public:
+    static constexpr size_t RING_CAPACITY = 1 << 16;    // Samples, about 11 s of a full three-car train
+    static constexpr size_t BLOCK_ROWS = 4096;          // Samples per column block in the file
+    static constexpr double FILTER_BANDWIDTH = 5.0;     // Hz, low-pass on the reported acceleration
+
+    Telemetry();
+    ~Telemetry();
+
+    // Create the file and start the writer thread
+    // tickRate is the simulation rate in Hz, metresPerUnit the scale of world units
+    // waitWhenFull makes sample() wait for the writer instead of dropping samples
+    bool start(const std::string& path, float tickRate, bool waitWhenFull = false, float metresPerUnit = 0.25f);
+
+    // Write out everything sampled so far, close the file and print a summary
+    void stop();
+
+    bool isRunning() const { return writer.joinable(); }
+
+    // Sample every seat after the simulation step for tick
+    // The first tick after a start, a gap or the wagon being placed only primes the history
+    // Moves the wagon's drawn pose to the current simulation step, which render interpolation overrides
+    void sample(WagonState& wagon, const TrackPath& path, uint32_t tick);
+
+    uint64_t getSampleCount() const { return samplesPushed; }
+    uint64_t getDroppedCount() const { return samplesDropped; }
+
+private:
+    // Seat state from the previous tick
+    struct SeatHistory
+    {
+        glm::dvec3 rotation;        // Angular velocity of the car, rad/s, for its angular acceleration
+        glm::dvec3 filtered[2];     // Acceleration after the first and both low-pass stages, m/s^2
+        bool valid;
+    };
+
+    void writerLoop();
+    void flushBlock();
+
+    SpscRingBuffer<TelemetrySample> ring;
+    std::vector<SeatHistory> seats;
+    uint32_t lastTick;
+    float lastTrackT;
+    double lastVelocity;        // World units per second
+    float tickRate;
+    float metresPerUnit;
+    bool waitWhenFull;
+    uint64_t samplesPushed;
+    uint64_t samplesDropped;
+
+    // Peaks over the session, kept on the simulation side for the summary
+    float minVertical, maxVertical, maxLateral, maxLongitudinal, maxJerk;
+
+    // Writer thread state
+    std::thread writer;
+    std::atomic<bool> stopRequested;
+    std::ofstream file;
+    std::string filePath;
+    std::vector<TelemetrySample> scratch;
+    std::vector<TelemetrySample> block;
+    uint64_t blocksWritten;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include "parallel.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool for many independent tasks of uneven length
+// Every worker has its own task deque: it takes its newest task from the back, and when its deque
+// runs dry it steals the oldest task from the front of another worker's deque. Tasks submitted from
+// outside the pool are dealt round robin over the deques, tasks submitted by a task go to the
+// deque of the worker running it. One lock per deque, so workers only contend when stealing.
+class WorkStealingPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    explicit WorkStealingPool(unsigned int threads = workerCount());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()); }
+
+    void submit(Task task);
+
+    // Block until every task submitted so far, and every task they submitted, has run
+    // Not for use inside a task
+    void wait();
+
+    // parallelFor on the pool's threads: split [begin, end) into up to one chunk per worker of at
+    // least minChunk items, run fn(chunkBegin, chunkEnd) on each and wait for all of them
+    // The calling thread takes the first chunk. Not for use inside a task
+    void parallelFor(size_t begin, size_t end, size_t minChunk, const std::function<void(size_t, size_t)>& fn);
+
+    // Tasks taken from another worker's deque since the pool started
+    size_t getStealCount() const { return steals; }
+
+private:
+    struct TaskQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(unsigned int index);
+    bool takeTask(unsigned int index, Task& task);
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued;     // Tasks waiting in the deques
+    std::atomic<size_t> unfinished; // Tasks submitted and not yet finished
+    std::atomic<size_t> steals;
+    std::atomic<unsigned int> nextQueue;
+    bool stopping;
+
+    // Idle workers sleep on wake, wait() sleeps on done
+    std::mutex idleMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef TRACKINDEX_HPP
+#define TRACKINDEX_HPP
+
+#include <glm/glm.hpp>
+#include <cfloat>
+#include <vector>
+
+class TrackPath;
+
+// Point on the track center line found by a spatial query
+struct TrackHit
+{
+    float t;             // Spline parameter [0, 1]
+    float distance;      // Distance along the track
+    glm::vec3 position;  // Point on the center line
+    float separation;    // Distance from the query point (or ray) to that point
+    float rayDistance;   // Distance along the ray, for ray queries
+};
+
+// Bounding volume hierarchy over the spline segments of a TrackPath, for turning world positions
+// back into track parameters (picking, placing trains, proximity triggers).
+// Segment i covers t in [i, i + 1] / (numPoints - 1). Queries run in logarithmic time in the number
+// of segments; each segment is tested as a short polyline and the best match is then refined on
+// the spline itself.
+class TrackSpatialIndex
+{
+public:
+    TrackSpatialIndex();
+
+    // Build over the current path; the path must outlive the index and be rebuilt if it changes
+    void build(const TrackPath& path);
+    void clear();
+    bool isBuilt() const { return path != nullptr && !nodes.empty(); }
+
+    // Closest point on the center line to a world position
+    TrackHit closestPoint(const glm::vec3& position) const;
+    float closestParameter(const glm::vec3& position) const { return closestPoint(position).t; }
+
+    // Indices of the segments passing within radius of a position, in ascending order
+    void segmentsInRadius(const glm::vec3& position, float radius, std::vector<int>& out) const;
+
+    // First place where a ray passes within radius of the center line
+    // direction need not be normalized; returns false if the ray misses
+    bool raycast(const glm::vec3& origin, const glm::vec3& direction, float radius, TrackHit& hit,
+                 float maxDistance = FLT_MAX) const;
+
+    int getNumSegments() const { return numSegments; }
+
+private:
+    // Leaves hold up to LEAF_SIZE segments; inner nodes keep their left child right after them
+    struct Node
+    {
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+        int first;   // Leaf: first entry in segmentOrder. Inner: index of the right child
+        int count;   // Number of segments in a leaf, 0 for inner nodes
+    };
+
+    // Recursively build nodes over segmentOrder[begin, end)
+    int buildNode(int begin, int end, const std::vector<glm::vec3>& centers);
+
+    // Squared distance from a point to segment i's polyline, and the spline parameter there
+    float segmentDistanceSq(int segment, const glm::vec3& position, float& t) const;
+
+    // Move a spline parameter to the true closest point on the spline near it
+    TrackHit refine(float t, const glm::vec3& position) const;
+
+    static constexpr int SUBDIVISIONS = 4;  // Polyline edges per spline segment
+    static constexpr int LEAF_SIZE = 4;
+
+    const TrackPath* path;
+    int numSegments;
+    std::vector<Node> nodes;
+    std::vector<int> segmentOrder;
+    std::vector<glm::vec3> samples;       // numSegments * SUBDIVISIONS + 1 points along the spline
+    std::vector<glm::vec3> segmentMin;    // Segment bounds, padded by the spline's deviation
+    std::vector<glm::vec3> segmentMax;    //   from its polyline
+};
+
+#endif
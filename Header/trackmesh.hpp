@@ -0,0 +1,139 @@
+#ifndef TRACKMESH_HPP
+#define TRACKMESH_HPP
+
+#include <glm/glm.hpp>
+#include <vector>
+
+class TrackPath;
+
+// Cross-section profile and tessellation settings for a generated track
+// Profile offsets are in the track frame: x along right, y along up (world units)
+struct TrackMeshSettings
+{
+    // Largest allowed gap between the mesh and the true swept surface; straights get long
+    // segments, tight curves and fast rolls get short ones
+    float tolerance = 0.05f;
+    float minStep = 0.25f;
+    float maxStep = 8.0f;
+
+    // Two running rails
+    float railGauge = 5.0f;
+    float railHeight = 0.4f;
+    float railRadius = 0.35f;
+    int railSides = 8;
+
+    // Spine tube below the rails
+    float spineDepth = 1.2f;
+    float spineRadius = 0.6f;
+    int spineSides = 8;
+
+    // Cross ties under the rails: width (right), height (up), length (forward)
+    float tieSpacing = 3.0f;
+    glm::vec3 tieSize = glm::vec3(5.6f, 0.3f, 0.6f);
+
+    // Level of detail: the track is cut into chunks of about chunkLength, each built at lodCount
+    // levels. Every level multiplies the tolerance by lodToleranceScale and drops two tube sides,
+    // and ties are only kept on the first two. A chunk is drawn at the coarsest level whose error
+    // projects to at most maxPixelError pixels.
+    float chunkLength = 20.0f;
+    int lodCount = 4;
+    float lodToleranceScale = 2.0f;
+    float maxPixelError = 1.0f;
+};
+
+// Track geometry swept along a TrackPath, drawn from one indexed vertex buffer
+// that holds every level of detail of every chunk
+class TrackMesh
+{
+public:
+    static constexpr int MAX_LODS = 8;
+
+    // What the last draw submitted
+    struct DrawStats
+    {
+        int drawCalls;
+        int trianglesSubmitted;
+        int trianglesFullDetail;        // Same view with every chunk at level 0
+        int chunksPerLod[MAX_LODS];
+    };
+
+    TrackMesh();
+    ~TrackMesh();
+
+    // Build full-detail geometry for the whole track on the CPU:
+    // 8 floats per vertex (position, normal, uv) and triangle indices
+    static void generate(const TrackPath& path, const TrackMeshSettings& settings,
+                         std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+    // Generate all chunks and levels and upload them to the GPU (replaces any previous mesh)
+    void build(const TrackPath& path, const TrackMeshSettings& settings = TrackMeshSettings());
+
+    // build() in two stages: prepare() generates the geometry and needs no GL context, so it can run on
+    // a worker; upload() moves it to the GPU on the GL thread. Draw only after upload()
+    void prepare(const TrackPath& path, const TrackMeshSettings& settings = TrackMeshSettings());
+    void upload();
+
+    // Draw every chunk at full detail with the caller's shader state (model matrix, material)
+    void draw();
+
+    // Draw with a level per chunk chosen from the camera position
+    // pixelScale is the viewport height in pixels divided by 2 * tan(fovY / 2)
+    void draw(const glm::vec3& cameraPos, float pixelScale);
+
+    // Level per chunk for a camera, as used by draw
+    void selectLods(const glm::vec3& cameraPos, float pixelScale, std::vector<int>& lods) const;
+
+    // Free the geometry and its GL buffers; needs the GL context if anything was uploaded
+    void release();
+
+    const DrawStats& getLastDrawStats() const { return lastStats; }
+    int getNumChunks() const { return static_cast<int>(chunks.size()); }
+
+    // Full-detail size of the track
+    int getVertexCount() const { return vertexCount; }
+    int getTriangleCount() const { return fullDetailIndices / 3; }
+
+private:
+    TrackMesh(const TrackMesh&) = delete;
+    TrackMesh& operator=(const TrackMesh&) = delete;
+
+    struct Chunk
+    {
+        glm::vec3 center;
+        float radius;
+    };
+
+    // Index range of one level of one chunk
+    struct LodRange
+    {
+        unsigned int firstIndex;
+        int indexCount;
+    };
+
+    // Generate every level of every chunk; levels are stored level-major so neighbouring chunks
+    // at the same level are contiguous and can be drawn with one call
+    void generateLods(const TrackPath& path, const TrackMeshSettings& settings,
+                      std::vector<float>& vertices, std::vector<unsigned int>& indices);
+
+    // Draw with the given level per chunk
+    void draw(const std::vector<int>& lods);
+
+    void releaseBuffers();
+
+    unsigned int VAO, VBO, EBO;
+    int vertexCount;
+    int fullDetailIndices;
+    float maxPixelError;
+
+    std::vector<Chunk> chunks;
+    std::vector<LodRange> lodRanges;   // lodRanges[lod * chunks.size() + chunk]
+    std::vector<float> lodErrors;      // Largest deviation from the full sweep per level
+    std::vector<int> selectedLods;
+    DrawStats lastStats;
+
+    // Geometry from prepare() waiting for upload()
+    std::vector<float> pendingVertices;
+    std::vector<unsigned int> pendingIndices;
+};
+
+#endif
@@ -2,10 +2,42 @@
 #define TRACKPATH_HPP
 
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 class Model;
 
+// Orthonormal frame on the track center line
+struct TrackFrame
+{
+    glm::vec3 position;
+    glm::vec3 forward;
+    glm::vec3 up;
+    glm::vec3 right;
+};
+
+// How the frame turns per unit of distance along the track
+struct TrackFrameRates
+{
+    glm::vec3 curvature;    // d(forward)/ds: curvature times the principal normal, per world unit
+    glm::vec3 rotation;     // Angular velocity of the frame per world unit travelled, in radians
+};
+
+// Structure-of-arrays frames from a batched query, one entry per input
+struct TrackFrameBatch
+{
+    std::vector<float> posX, posY, posZ;
+    std::vector<float> forwardX, forwardY, forwardZ;
+    std::vector<float> upX, upY, upZ;
+    std::vector<float> rightX, rightY, rightZ;
+
+    void resize(size_t count);
+    size_t size() const { return posX.size(); }
+};
+
 class TrackPath
 {
 public:
@@ -13,9 +45,33 @@ public:
     ~TrackPath() = default;
 
     // Extract center line from track model
-    // Assumes track has segments of verticesPerSegment vertices each
+    // Assumes track has segments of verticesPerSegment vertices each,
+    // and falls back to automatic detection when the mesh is smaller than that layout
     void extractFromModel(const Model& trackModel, int numSegments = 300, int verticesPerSegment = 384);
 
+    // Extract center line from a track model of any layout
+    // Cross-sections are found by clustering the vertex positions and ordered along the track
+    void extractFromModelAuto(const Model& trackModel);
+
+    // Same extraction from raw vertex positions, for callers without a GL-backed Model
+    // edgeLength is the typical triangle edge length, which sizes the automatic detection grid
+    // (0 lets detection pick a size from the bounds)
+    void extractFromVertices(const std::vector<glm::vec3>& vertices, float edgeLength,
+                             int numSegments = 300, int verticesPerSegment = 384);
+    void extractFromVerticesAuto(const std::vector<glm::vec3>& vertices, float edgeLength);
+
+    // Binary cache of the extracted path and its derived tables, so a warm start skips extraction
+    // The key hashes the source mesh's contents and the extraction settings (0 if the source can't be read)
+    static uint64_t computeCacheKey(const std::string& sourcePath, int numSegments = 300, int verticesPerSegment = 384);
+
+    // Load the cache if it was extracted with these settings from this source, and return its key
+    // The source is only hashed when its size or modification time differ from the ones recorded;
+    // without the source the cache is trusted as it is, so a cache ships without its mesh
+    bool loadFromCache(const std::string& cachePath, const std::string& sourcePath, uint64_t& key,
+                       int numSegments = 300, int verticesPerSegment = 384);
+    bool saveToCache(const std::string& cachePath, const std::string& sourcePath, uint64_t key,
+                     int numSegments = 300, int verticesPerSegment = 384) const;
+
     // Get position along the track at parameter t [0, 1]
     // Uses Catmull-Rom spline interpolation for smooth movement
     glm::vec3 getPosition(float t) const;
@@ -24,12 +80,47 @@ public:
     glm::vec3 getForward(float t) const;
 
     // Get up vector at parameter t [0, 1]
-    // Approximates the "up" based on track banking
+    // Read from the frame table baked at load
     glm::vec3 getUp(float t) const;
 
     // Get the right vector at parameter t [0, 1]
     glm::vec3 getRight(float t) const;
 
+    // Evaluate position, tangent, up and right together at parameter t [0, 1]
+    // Finds the segment once and uses the analytic spline derivative for the tangent
+    TrackFrame evaluateFrame(float t) const;
+
+    // Arc-length parameterization (distances are in world units along the center line)
+    // Total length of the center line
+    float getLength() const { return totalLength; }
+
+    // Convert between spline parameter t [0, 1] and distance along the track [0, getLength()]
+    // Both directions are constant-time table lookups
+    float parameterToDistance(float t) const;
+    float distanceToParameter(float distance) const;
+
+    // Frame queries by distance along the track, so equal steps cover equal world distances
+    glm::vec3 getPositionAtDistance(float distance) const;
+    glm::vec3 getForwardAtDistance(float distance) const;
+    glm::vec3 getUpAtDistance(float distance) const;
+    glm::vec3 getRightAtDistance(float distance) const;
+    TrackFrame evaluateFrameAtDistance(float distance) const;
+
+    // Curvature from the spline's first and second derivatives, and the frame's rotation:
+    // forward x curvature for the bend plus the twist of the baked frames about forward
+    TrackFrameRates evaluateFrameRatesAtDistance(float distance) const;
+
+    // Batched queries over many parameters at once (SSE2/AVX2 when available, scalar otherwise)
+    // Up vectors are normalized-lerped between baked frames, which is within float noise of
+    // the slerp used by the single queries at the table density used here
+    void evaluatePositions(const float* ts, size_t count, float* outX, float* outY, float* outZ) const;
+    void evaluateFrames(const float* ts, size_t count, TrackFrameBatch& out) const;
+    void evaluateFramesAtDistance(const float* distances, size_t count, TrackFrameBatch& out) const;
+
+    // Fill entries [begin, end) of a batch the caller has already sized, from distances[begin, end)
+    // Disjoint ranges of the same batch can be filled from different threads
+    void evaluateFramesAtDistance(const float* distances, size_t begin, size_t end, TrackFrameBatch& out) const;
+
     // Get total number of center points extracted
     int getNumPoints() const { return static_cast<int>(centerPoints.size()); }
 
@@ -39,22 +130,102 @@ public:
     // Check if path has been initialized
     bool isInitialized() const { return !centerPoints.empty(); }
 
+    // Extraction benchmark, which times the private averaging and smoothing stages
+    friend void benchmarkTrackExtraction();
+
+    // Minimum items per thread for the parallel extraction loops
+    static constexpr size_t PARALLEL_GRAIN = 16384;
+
 private:
+    // Drop all extracted data and derived tables
+    void clear();
+
+    // Hash of the extraction settings and the cache version, which seeds the cache key
+    static uint64_t settingsKey(int numSegments, int verticesPerSegment);
+
     // Catmull-Rom spline interpolation
     glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1,
                          const glm::vec3& p2, const glm::vec3& p3, float t) const;
 
+    // Derivative of the Catmull-Rom spline with respect to local t
+    glm::vec3 catmullRomDerivative(const glm::vec3& p0, const glm::vec3& p1,
+                                   const glm::vec3& p2, const glm::vec3& p3, float t) const;
+
+    // Second derivative of the Catmull-Rom spline with respect to local t
+    glm::vec3 catmullRomSecondDerivative(const glm::vec3& p0, const glm::vec3& p1,
+                                         const glm::vec3& p2, const glm::vec3& p3, float t) const;
+
+    // Get the 4 control point indices around a segment
+    void getControlIndices(int index, int& i0, int& i1, int& i2, int& i3) const;
+
+    // Find cross-section centers in raw vertex positions and store them in track order
+    // cellSize is the initial clustering cell size (see trackpath_segments.cpp)
+    bool detectCenterPoints(const std::vector<glm::vec3>& vertices, float cellSize);
+
+    // Center points as the mean of each run of verticesPerSegment vertices
+    void averageSegments(const std::vector<glm::vec3>& vertices, int numSegments, int verticesPerSegment);
+
+    // Smooth the extracted center points and build all derived tables
+    void finishExtraction();
+
+    // Evaluate the frame when both the parameter and the distance are already known
+    TrackFrame evaluateFrame(float t, float distance) const;
+
+    // Interpolated orientation from the frame table at a distance along the track
+    glm::quat sampleFrame(float distance) const;
+
+    // Copy center points and frames into the structure-of-arrays layout used by batched queries
+    void buildBatchTables();
+
+    // Shared batch entry point; outputs holds 12 SoA arrays (position, forward, up, right),
+    // the last 9 may be null for position-only queries
+    void evaluateBatch(const float* input, size_t count, bool byDistance, float* const* outputs) const;
+
     // Get index and local t for a global t value
     void getSegmentInfo(float t, int& index, float& localT) const;
 
+    // Build cumulative arc-length table and its inverse resampled at uniform distances
+    void buildArcLengthTable();
+
     // Smooth a vector of points using multiple passes of moving average
+    // windowSize is at most SMOOTH_WINDOW; passes ping-pong with smoothScratch
     void smoothPoints(std::vector<glm::vec3>& points, int passes, int windowSize);
 
-    // Smooth and normalize a vector of direction vectors
-    void smoothDirections(std::vector<glm::vec3>& directions, int passes, int windowSize);
+    // Bake rotation minimizing frames at uniform distances (needs the arc-length tables)
+    void buildFrameTable();
 
     std::vector<glm::vec3> centerPoints;  // Center line points (300 points)
-    std::vector<glm::vec3> upVectors;     // Approximate up vectors for banking
+
+    // Extraction settings
+    static constexpr int SMOOTH_PASSES = 3;
+    static constexpr int SMOOTH_WINDOW = 5;
+    std::vector<glm::vec3> smoothScratch;  // Kept between extractions so smoothing doesn't allocate
+
+    // Arc-length tables
+    static constexpr int ARC_SAMPLES_PER_SEGMENT = 16;
+    std::vector<float> arcLengths;   // Cumulative distance at uniform steps of t
+    std::vector<float> distanceToT;  // Parameter t at uniform steps of distance
+    float totalLength;
+    float distanceStep;              // Distance between entries of distanceToT and frames
+
+    // Orientation at uniform steps of distance (maps local +Y to up and +Z to forward)
+    std::vector<glm::quat> frames;
+
+    // Structure-of-arrays copies for batched queries
+    std::vector<float> pointsX, pointsY, pointsZ;
+    std::vector<float> framesW, framesX, framesY, framesZ;
 };
 
+// Time the fused evaluateFrame against a copy of the separate queries it replaced (finite-difference
+// tangent, interpolated up, right recomputing both), and print the cost per frame and the speedup
+void benchmarkFrameEvaluation(const TrackPath& path);
+
+// Throughput of the batched evaluateFrames against evaluateFrame in a loop at 1K, 100K and
+// 10M samples, both writing the same structure-of-arrays output
+void benchmarkBatchEvaluation(const TrackPath& path);
+
+// Segment averaging and smoothing of synthetic tracks from 300 to 10M segments, against a
+// single-threaded reference of the original per-pass allocating version, checked bit for bit
+void benchmarkTrackExtraction();
+
 #endif
@@ -0,0 +1,90 @@
+#ifndef TRAINSYSTEM_HPP
+#define TRAINSYSTEM_HPP
+
+#include "trackpath.hpp"
+#include "wagonstate.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class TrainDynamics;
+class WorkStealingPool;
+
+// Simulation state of many trains on one track, stored as parallel arrays
+// Runs the same ride model as WagonState for single-car trains, and advances every train in one pass
+class TrainSystem
+{
+public:
+    using State = WagonState::RideState;
+
+    TrainSystem();
+    ~TrainSystem();
+
+    // Add a train at fraction t of the track length, returns its index
+    size_t addTrain(float t, State state = State::STOPPED, float velocity = 0.0f);
+    void clear();
+    size_t size() const { return trackT.size(); }
+
+    // Physical dynamics for the chain lift and free running; nullptr keeps the arcade model
+    void setDynamics(const TrainDynamics* dyn) { dynamics = dyn; }
+
+    // Tuning of the arcade model, the same parameters as WagonState's
+    void setArcadeParams(const WagonState::ArcadeParams& params) { arcade = params; }
+    const WagonState::ArcadeParams& getArcadeParams() const { return arcade; }
+
+    // Threads for parallel steps, not owned; without one the system starts its own pool on first use
+    void setPool(WorkStealingPool* workers) { pool = workers; }
+
+    // Advance every train by one fixed step and refresh their frames
+    // Splits the trains across the pool when parallel is set and there are enough of them
+    void step(const TrackPath& path, float deltaTime, bool parallel = true);
+
+    // Run fn over chunks of [0, size()) on the pool, for per-train passes like the block update
+    void forEachRange(size_t minChunk, const std::function<void(size_t, size_t)>& fn);
+
+    // Per-train access; velocities are in track lengths per second
+    State getState(size_t i) const { return states[i]; }
+    float getTrackParameter(size_t i) const { return trackT[i]; }
+    float getVelocity(size_t i) const { return velocity[i]; }
+    void setState(size_t i, State state) { states[i] = state; }
+    void setTrackParameter(size_t i, float t) { trackT[i] = t; framesDirty = true; }
+
+    // Move a train without touching shared state, so different trains can be moved from different
+    // threads; call invalidateFrames() once afterwards, from one thread
+    void moveTrain(size_t i, float t) { trackT[i] = t; }
+    void invalidateFrames() { framesDirty = true; }
+    void setVelocity(size_t i, float v) { velocity[i] = v; }
+    void setAcceleration(size_t i, float a) { acceleration[i] = a; }
+
+    // Track frames at every train's position after the last step (center line, no height offset)
+    const TrackFrameBatch& getFrames() const { return frames; }
+
+    // Minimum trains per thread in a parallel step
+    static constexpr size_t PARALLEL_GRAIN = 4096;
+
+private:
+    // Advance trains [begin, end); frames must hold their current positions
+    void stepRange(const TrackPath& path, float deltaTime, size_t begin, size_t end);
+
+    std::vector<State> states;
+    std::vector<float> trackT;        // Fraction of the track length [0, 1)
+    std::vector<float> velocity;      // Track lengths per second
+    std::vector<float> acceleration;  // Used in DECELERATING and BRAKING
+    std::vector<float> distances;     // Scratch: trackT times the track length
+
+    TrackFrameBatch frames;
+    bool framesDirty;
+    const TrainDynamics* dynamics;
+    WagonState::ArcadeParams arcade;
+
+    WorkStealingPool* pool;
+    std::unique_ptr<WorkStealingPool> ownPool;
+};
+
+// Time one simulated second of 1K, 10K and 100K trains on one thread and on all of them,
+// and print the cost per train step
+void benchmarkTrainSystem(const TrackPath& path);
+
+#endif
@@ -7,6 +7,26 @@ void limitFPS(double& lastTimeForRefresh, int targetFPS = 75);
 // Texture Loading
 unsigned int loadTexture(const char* path);
 
+// Pixels decoded on the CPU, waiting to become a GL texture
+struct ImageData
+{
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    int channels = 0;       // Components per pixel in pixels
+    int fileChannels = 0;   // Components per pixel in the file
+};
+
+// Decode an image file; safe on any thread
+// channels forces the components per pixel (0 keeps the file's), flip turns the image upside down for OpenGL
+bool decodeImage(const char* path, ImageData& image, int channels = 4, bool flip = true);
+
+// Create a mipmapped texture from decoded pixels and free them; needs the GL context
+// path only names the image in the log; repeat wraps the texture instead of clamping it
+unsigned int uploadTexture(ImageData& image, const char* path, bool repeat = false);
+
+void freeImage(ImageData& image);
+
 // Overlay Setup
 void setupOverlayQuad(unsigned int& VAO, unsigned int& VBO);
 
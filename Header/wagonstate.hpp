@@ -0,0 +1,188 @@
+#ifndef WAGONSTATE_HPP
+#define WAGONSTATE_HPP
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "eventqueue.hpp"
+#include "trackpath.hpp"
+
+class TrainDynamics;
+
+// Simulation side of the ride train: ride state, motion along the track and car poses
+// Has no GL state, so it runs the same way in the game and in the headless simulator
+class WagonState
+{
+public:
+    // Ride state
+    // BRAKING and HOLDING are set by BlockSystem on the trains of a TrainSystem, which shares this
+    // enum; the game's single wagon never has a block ahead held by another train, so never uses them
+    enum class RideState : uint8_t
+    {
+        STOPPED,      // Not moving
+        STARTING,     // Accelerating to cruise speed (chain lift)
+        RUNNING,      // Normal physics (gravity affects speed)
+        DECELERATING, // Slowing down (sick passenger)
+        CONSTANT,     // Constant velocity (reverse)
+        BRAKING,      // Block brake: slowing down to stop before an occupied block
+        HOLDING       // Held by the block brake until the block ahead is clear
+    };
+
+    // What the wagon reports from a simulation step, for the game to react to instead of polling
+    enum class RideEvent : uint8_t
+    {
+        SPEED_REACHED,      // Speed rose to the watched speed
+        STOPPED,            // Slowdown came to a standstill (DECELERATING ended in STOPPED)
+        LAP_COMPLETED,      // Lead car crossed the lap marker moving forward
+        STATION_REACHED     // Lead car crossed the station marker, in either direction
+    };
+
+    static constexpr size_t EVENT_CAPACITY = 16;    // A step raises at most one of each
+
+    struct CarPose
+    {
+        glm::vec3 position;
+        glm::vec3 forward;
+        glm::vec3 up;
+        glm::vec3 right;
+    };
+
+    static constexpr int SEATS_PER_CAR = 8;
+
+    // Arcade model constants, in track lengths per second
+    static constexpr float CHAIN_LIFT_ACCEL = 0.2f;  // Acceleration during startup
+    static constexpr float CRUISE_SPEED = 0.15f;      // Target speed after startup
+    static constexpr float GRAVITY_EFFECT = 0.04f;    // How much slope affects acceleration
+    static constexpr float FRICTION = 0.01f;          // Friction/drag coefficient
+    static constexpr float MIN_VELOCITY = 0.02f;     // Minimum velocity
+    static constexpr float MAX_VELOCITY = 0.12f;      // Maximum velocity cap
+
+    // Arcade model tuning that can change at run time (parameter sweeps); defaults are the constants above
+    struct ArcadeParams
+    {
+        float chainLiftAccel = CHAIN_LIFT_ACCEL;
+        float cruiseSpeed = CRUISE_SPEED;
+        float gravityEffect = GRAVITY_EFFECT;
+        float friction = FRICTION;
+        float minVelocity = MIN_VELOCITY;
+        float maxVelocity = MAX_VELOCITY;
+    };
+
+    // Body dimensions of one car (world units), which also lay out the seats
+    WagonState(float width = 10.0f, float height = 5.0f, float depth = 8.0f);
+
+    // Position and orientation of the lead car
+    void setPosition(const glm::vec3& pos);
+    glm::vec3 getPosition() const { return cars[0].position; }
+
+    // Set orientation using forward and up vectors
+    void setOrientation(const glm::vec3& forward, const glm::vec3& up);
+
+    // Couple count cars behind each other, with gap world units between their bodies
+    // The track parameter belongs to the lead car; the others follow at fixed arc-length offsets
+    void setCarCount(int count, float gap = 1.0f);
+    int getCarCount() const { return static_cast<int>(cars.size()); }
+    float getCarSpacing() const { return carSpacing; }  // Between car centers along the track
+    const CarPose& getCarPose(int index) const { return cars[index]; }
+
+    // Place the wagon at fraction t of the track length (no interpolation from the previous step)
+    void updateFromTrackPath(const TrackPath& path, float t);
+
+    // Advance the simulation by one fixed step; the drawn pose is only updated by interpolate()
+    void updatePhysics(const TrackPath& path, float deltaTime);
+
+    // Set the drawn pose between the last two simulation steps (alpha 0 = previous, 1 = current)
+    void interpolate(const TrackPath& path, float alpha);
+
+    // Ride control
+    void startRide();
+    void stopRide();
+    void stop();  // Fully stop (sets velocity to 0 and state to STOPPED)
+    void setConstantVelocity(float vel);  // Set constant velocity mode (for reverse)
+    void setDeceleration(float decel);    // Set deceleration mode (for slowdown)
+    bool isRideRunning() const { return rideState != RideState::STOPPED; }
+    RideState getRideState() const { return rideState; }
+
+    // Get current track parameter (fraction of track length, uniform in world distance)
+    float getTrackParameter() const { return trackT; }
+    void setTrackParameter(float t) { trackT = t; previousT = t; }
+
+    float getVelocity() const { return velocity; }
+
+    // Physical dynamics for the chain lift and free running; nullptr keeps the arcade model
+    // The scripted slowdown and reverse are unchanged, and velocity stays in track lengths per second
+    void setDynamics(const TrainDynamics* dyn) { dynamics = dyn; }
+    bool hasDynamics() const { return dynamics != nullptr; }
+
+    // Tuning of the arcade model; the physical model only takes the chain lift's cruise speed from it
+    void setArcadeParams(const ArcadeParams& params) { arcade = params; }
+    const ArcadeParams& getArcadeParams() const { return arcade; }
+
+    // Events are raised in updatePhysics and wait here until the game takes them
+    // Markers are track fractions; a negative value (the default) turns one off
+    void watchSpeed(float speed) { watchedSpeed = speed; }
+    void setLapMarker(float t) { lapMarker = t; }
+    void setStationMarker(float t) { stationMarker = t; }
+    bool pollEvent(RideEvent& event) { return events.pop(event); }
+    void clearEvents() { events.clear(); }
+
+    // Chain the simulation state (position, motion, ride state and model) into seed
+    uint64_t hashState(uint64_t seed) const;
+
+    // Height offset above the track center line
+    void setHeightOffset(float offset) { heightOffset = offset; }
+
+    struct SeatTransform {
+        glm::vec3 position;
+        glm::vec3 forward;
+        glm::vec3 up;
+        glm::vec3 right;
+    };
+    // Seats are numbered car by car from the front, SEATS_PER_CAR to a car
+    SeatTransform getSeatWorldTransform(int index) const;
+
+protected:
+    float width, height, depth;
+
+private:
+    // Set the pose of every car from the track frames, with the lead car at fraction t
+    void applyTrackPose(const TrackPath& path, float t);
+
+    // Track frames under every car with the lead car at fraction t, in one batched query
+    void evaluateCarFrames(const TrackPath& path, float t);
+
+    // Slope averaged over the cars, which all weigh the same
+    float averageSlope(const TrackPath& path, float t);
+
+    // Move the wagon by one step; updatePhysics then raises the events of the step
+    void advance(const TrackPath& path, float deltaTime);
+
+    // True if the step from previousT to trackT passed marker
+    bool crossed(float marker, bool forward) const;
+
+    // Pose of every car, lead car first
+    std::vector<CarPose> cars;
+    float carSpacing;
+    std::vector<float> carDistances;  // Scratch for the batched frame query
+    TrackFrameBatch carFrames;
+
+    float trackT;        // Current position on track as a fraction of its length [0, 1]
+    float previousT;     // trackT before the last simulation step, for render interpolation
+    float heightOffset;  // Height above track center
+
+    // Physics state
+    RideState rideState;
+    float velocity;      // Current velocity in track lengths per second
+    float acceleration;  // Current acceleration (used in DECELERATING mode)
+    const TrainDynamics* dynamics;  // Physical model, not owned
+    ArcadeParams arcade;
+
+    // Event sources: -1 when off
+    float watchedSpeed;
+    float lapMarker;
+    float stationMarker;
+    EventQueue<RideEvent, EVENT_CAPACITY> events;
+};
+
+#endif
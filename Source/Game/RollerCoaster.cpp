@@ -1,153 +1,206 @@
 #include "../../Header/Game/RollerCoaster.hpp"
-#include "../../Header/Game/Constants.hpp"
-#include "../../Header/wagon.hpp"
+#include "../../Header/wagonstate.hpp"
 #include "../../Header/trackpath.hpp"
+#include "../../Header/mappedfile.hpp"
+#include <algorithm>
 #include <iostream>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+const int BITS_PER_WORD = 64;
+
+// Index of the lowest set bit; word must not be 0
+int lowestSetBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+} // namespace
 
-RollerCoaster::RollerCoaster(Wagon& wagon, const TrackPath& trackPath)
-    : wagon(wagon), trackPath(trackPath), gameState(GameState::ONBOARDING), cooldownTimer(0.0f), passedMidpoint(false)
+RollerCoaster::RollerCoaster(WagonState& wagon, const TrackPath& trackPath, const RideConfig& config)
+    : wagon(wagon), trackPath(trackPath), config(config), gameState(GameState::ONBOARDING), cooldownTimer(0.0f),
+      passengerCount(0), buckledCount(0)
 {
-    wagon.setTrackParameter(START_TRACK_T);
-    wagon.updateFromTrackPath(trackPath, START_TRACK_T);
+    seatCount = seatCapacity(config, wagon.getCarCount());
+
+    seats.reserve(seatCount);
+    for (int i = 0; i < seatCount; ++i) {
+        seats.emplace_back(i);
+    }
+    occupied.assign((seatCount + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+    if (seatCount % BITS_PER_WORD != 0) {
+        occupied.back() = ~uint64_t(0) << (seatCount % BITS_PER_WORD);
+    }
+
+    wagon.setTrackParameter(config.startTrackT);
+    wagon.updateFromTrackPath(trackPath, config.startTrackT);
+
+    // The wagon reports the lap and the return to the station, and drops what an earlier game left behind
+    wagon.setLapMarker(config.endTrackT);
+    wagon.setStationMarker(config.startTrackT);
+    wagon.clearEvents();
 }
 
 bool RollerCoaster::allPassengersBuckled() const {
-    for (const auto& p : passengers) {
-        if (!p.getHasSeatbelt()) {
-            return false;
-        }
-    }
-    return true;
+    return buckledCount == passengerCount;
 }
 
 bool RollerCoaster::hasPassengers() const {
-    return !passengers.empty();
+    return passengerCount > 0;
+}
+
+int RollerCoaster::seatCapacity(const RideConfig& config, int carCount) {
+    // Every seat of the train, unless the config asks for fewer
+    int trainSeats = carCount * WagonState::SEATS_PER_CAR;
+    return config.seats > 0 ? std::min(config.seats, trainSeats) : trainSeats;
 }
 
 int RollerCoaster::findFirstEmptySeat() const {
-    // Check seats 0-7, return first that's not occupied
-    for (int i = 0; i < static_cast<int>(MAX_PASSENGERS); ++i) {
-        bool occupied = false;
-        for (const auto& p : passengers) {
-            if (p.getSeatIndex() == i) {
-                occupied = true;
-                break;
-            }
-        }
-        if (!occupied) {
-            return i;
+    // First clear bit of the occupancy words; seats past the capacity are marked occupied
+    for (size_t w = 0; w < occupied.size(); ++w) {
+        uint64_t free = ~occupied[w];
+        if (free != 0) {
+            return static_cast<int>(w) * BITS_PER_WORD + lowestSetBit(free);
         }
     }
     return -1; // All seats full
 }
 
 Person* RollerCoaster::findPassengerBySeat(int seatIndex) {
-    for (auto& p : passengers) {
-        if (p.getSeatIndex() == seatIndex) {
-            return &p;
-        }
-    }
-    return nullptr;
+    return isSeatOccupied(seatIndex) ? &seats[seatIndex] : nullptr;
 }
 
 const Person* RollerCoaster::findPassengerBySeat(int seatIndex) const {
-    for (const auto& p : passengers) {
-        if (p.getSeatIndex() == seatIndex) {
-            return &p;
+    return isSeatOccupied(seatIndex) ? &seats[seatIndex] : nullptr;
+}
+
+int RollerCoaster::nextPassengerSeat(int seatIndex) const {
+    if (seatIndex < 0) {
+        seatIndex = 0;
+    }
+    if (seatIndex >= seatCount) {
+        return -1;
+    }
+
+    // Mask off the seats before seatIndex in its word, then the lowest set bit of each word is the next passenger
+    size_t w = static_cast<size_t>(seatIndex / BITS_PER_WORD);
+    uint64_t word = occupied[w] & (~uint64_t(0) << (seatIndex % BITS_PER_WORD));
+    for (;;) {
+        if (word != 0) {
+            int seat = static_cast<int>(w) * BITS_PER_WORD + lowestSetBit(word);
+            return seat < seatCount ? seat : -1;
         }
+        if (++w == occupied.size()) {
+            return -1;
+        }
+        word = occupied[w];
     }
-    return nullptr;
+}
+
+float RollerCoaster::travelledFromStart() const {
+    float travelled = wagon.getTrackParameter() - config.startTrackT;
+    if (travelled < 0.0f) {
+        travelled += 1.0f;
+    }
+    return travelled;
 }
 
 void RollerCoaster::update(float deltaTime) {
-    switch (gameState) {
-    case GameState::ONBOARDING:
-        // Nothing to update, waiting for user input
-        break;
+    // Transitions come from the events of the last simulation step; without any, only the cooldown has work
+    WagonState::RideEvent event;
+    while (wagon.pollEvent(event)) {
+        handleRideEvent(event);
+    }
 
-    case GameState::TAKEOFF:
-        // Wagon is accelerating via chain lift (handled by Wagon::updatePhysics in STARTING mode)
-        if (wagon.getVelocity() >= MAX_START_VELOCITY) {
-            // Transition to normal ride
+    if (gameState == GameState::COOLDOWN) {
+        cooldownTimer -= deltaTime;
+        if (cooldownTimer <= 0.0f) {
+            if (config.verbose) {
+                std::cout << "STATE: REVERSE (after cooldown)\n";
+            }
+            returnToStation();
+        }
+    }
+}
+
+void RollerCoaster::handleRideEvent(WagonState::RideEvent event) {
+    // Events that do not fit the current state are left over from an earlier phase of the ride
+    switch (event) {
+    case WagonState::RideEvent::SPEED_REACHED:
+        // Chain lift done (handled by WagonState::updatePhysics in STARTING mode), normal ride from here
+        if (gameState == GameState::TAKEOFF) {
             gameState = GameState::RIDE;
-            std::cout << "STATE: RIDE" << std::endl;
+            if (config.verbose) {
+                std::cout << "STATE: RIDE\n";
+            }
         }
         break;
 
-    case GameState::RIDE:
-        {
-            // Check if we've completed the loop (track t wraps around)
-            float currentT = wagon.getTrackParameter();
-            // When we pass END_TRACK_T coming from higher values, we've completed a loop
-            // Since the track loops at 1.0, we check if we're close to where we started
-            // and have been riding for a while (velocity > 0 means we're moving forward)
-
-            // Simple approach: if we've gone past 0.5 and come back near START_TRACK_T
-            // Track when we pass the midpoint to detect loop completion
-            if (currentT > 0.5f) {
-                passedMidpoint = true;
-            }
-            if (passedMidpoint && currentT < 0.3f && currentT >= END_TRACK_T) {
-                // We've looped around
-                passedMidpoint = false;
-                wagon.setConstantVelocity(REVERSE_VELOCITY);
-                gameState = GameState::REVERSE;
-                std::cout << "STATE: REVERSE (loop complete)" << std::endl;
+    case WagonState::RideEvent::LAP_COMPLETED:
+        if (gameState == GameState::RIDE) {
+            if (config.verbose) {
+                std::cout << "STATE: REVERSE (loop complete)\n";
             }
+            returnToStation();
         }
         break;
 
-    case GameState::SLOWDOWN:
-        if (wagon.getVelocity() <= 0.0f) {
+    case WagonState::RideEvent::STOPPED:
+        if (gameState == GameState::SLOWDOWN) {
             wagon.stop();
-            cooldownTimer = COOLDOWN_DURATION;
+            cooldownTimer = config.cooldownDuration;
             gameState = GameState::COOLDOWN;
-            std::cout << "STATE: COOLDOWN" << std::endl;
+            if (config.verbose) {
+                std::cout << "STATE: COOLDOWN\n";
+            }
         }
         break;
 
-    case GameState::COOLDOWN:
-        cooldownTimer -= deltaTime;
-        if (cooldownTimer <= 0.0f) {
-            wagon.setConstantVelocity(REVERSE_VELOCITY);
-            gameState = GameState::REVERSE;
-            std::cout << "STATE: REVERSE (after cooldown)" << std::endl;
+    case WagonState::RideEvent::STATION_REACHED:
+        if (gameState == GameState::REVERSE) {
+            arriveAtStation();
         }
         break;
+    }
+}
 
-    case GameState::REVERSE:
-        {
-            float currentT = wagon.getTrackParameter();
-            // Going backwards (negative velocity), so t decreases
-            // Need to handle wrap-around: if t goes below 0, it wraps to ~1.0
-            // We want to stop when we reach START_TRACK_T
-
-            // If we're moving backwards and reach/pass the start position
-            if (currentT <= START_TRACK_T || currentT > 0.9f) {
-                // Check if we wrapped around (t > 0.9 means we went from ~0 to ~1)
-                if (currentT > 0.9f) {
-                    // We wrapped, keep going
-                } else {
-                    // We've reached the start
-                    wagon.setTrackParameter(START_TRACK_T);
-                    wagon.updateFromTrackPath(trackPath, START_TRACK_T);
-                    wagon.stop();
-
-                    // Unbuckle all passengers
-                    for (auto& p : passengers) {
-                        p.setHasSeatbelt(false);
-                    }
-
-                    gameState = GameState::OFFBOARDING;
-                    std::cout << "STATE: OFFBOARDING" << std::endl;
-                }
-            }
-        }
-        break;
+void RollerCoaster::returnToStation() {
+    gameState = GameState::REVERSE;
+
+    // Back up to the station, unless the wagon is already past the seam and the station is just ahead
+    // (after a completed lap, or a stop late in the ride); then it rolls forward into it at the same speed
+    float travelled = travelledFromStart();
+    if (travelled <= 0.0f) {
+        arriveAtStation();
+    } else if (travelled >= 0.75f) {
+        wagon.setConstantVelocity(-config.reverseVelocity);
+    } else {
+        wagon.setConstantVelocity(config.reverseVelocity);
+    }
+}
 
-    case GameState::OFFBOARDING:
-        // Nothing to update, waiting for user to remove passengers
-        break;
+void RollerCoaster::arriveAtStation() {
+    wagon.setTrackParameter(config.startTrackT);
+    wagon.updateFromTrackPath(trackPath, config.startTrackT);
+    wagon.stop();
+
+    // Unbuckle all passengers
+    for (int seat = nextPassengerSeat(0); seat >= 0; seat = nextPassengerSeat(seat + 1)) {
+        seats[seat].setHasSeatbelt(false);
+    }
+    buckledCount = 0;
+
+    gameState = GameState::OFFBOARDING;
+    if (config.verbose) {
+        std::cout << "STATE: OFFBOARDING\n";
     }
 }
 
@@ -156,24 +209,25 @@ void RollerCoaster::handleAddPassenger() {
         return;
     }
 
-    if (passengers.size() >= MAX_PASSENGERS) {
-        std::cout << "All seats are full!" << std::endl;
-        return;
-    }
-
     int seatIndex = findFirstEmptySeat();
     if (seatIndex < 0) {
-        std::cout << "No empty seat found!" << std::endl;
+        if (config.verbose) {
+            std::cout << "All seats are full!\n";
+        }
         return;
     }
 
-    passengers.emplace_back(seatIndex);
-    std::cout << "Passenger added to seat " << (seatIndex + 1) << std::endl;
+    seats[seatIndex] = Person(seatIndex);
+    occupied[seatIndex / BITS_PER_WORD] |= uint64_t(1) << (seatIndex % BITS_PER_WORD);
+    ++passengerCount;
+    if (config.verbose) {
+        std::cout << "Passenger added to seat " << (seatIndex + 1) << '\n';
+    }
 }
 
 void RollerCoaster::handleSeatAction(int index) {
-    // index is 0-7 (from keys 1-8)
-    if (index < 0 || index >= static_cast<int>(MAX_PASSENGERS)) {
+    // index is 0-based (keys 1-8 reach the first eight seats)
+    if (index < 0 || index >= seatCount) {
         return;
     }
 
@@ -183,26 +237,31 @@ void RollerCoaster::handleSeatAction(int index) {
         // Toggle seatbelt
         if (passenger) {
             passenger->setHasSeatbelt(!passenger->getHasSeatbelt());
-            std::cout << "Passenger " << (index + 1) << " seatbelt: "
-                      << (passenger->getHasSeatbelt() ? "ON" : "OFF") << std::endl;
+            buckledCount += passenger->getHasSeatbelt() ? 1 : -1;
+            if (config.verbose) {
+                std::cout << "Passenger " << (index + 1) << " seatbelt: "
+                          << (passenger->getHasSeatbelt() ? "ON" : "OFF") << '\n';
+            }
         }
     }
     else if (gameState == GameState::OFFBOARDING) {
         // Remove passenger
         if (passenger) {
-            // Find and erase the passenger
-            for (auto it = passengers.begin(); it != passengers.end(); ++it) {
-                if (it->getSeatIndex() == index) {
-                    passengers.erase(it);
-                    std::cout << "Passenger " << (index + 1) << " removed" << std::endl;
-                    break;
-                }
+            if (passenger->getHasSeatbelt()) {
+                --buckledCount;
+            }
+            occupied[index / BITS_PER_WORD] &= ~(uint64_t(1) << (index % BITS_PER_WORD));
+            --passengerCount;
+            if (config.verbose) {
+                std::cout << "Passenger " << (index + 1) << " removed\n";
             }
 
             // Check if all passengers removed
-            if (passengers.empty()) {
+            if (passengerCount == 0) {
                 gameState = GameState::ONBOARDING;
-                std::cout << "STATE: ONBOARDING" << std::endl;
+                if (config.verbose) {
+                    std::cout << "STATE: ONBOARDING\n";
+                }
             }
         }
     }
@@ -210,15 +269,19 @@ void RollerCoaster::handleSeatAction(int index) {
         // Signal passenger is sick
         if (passenger) {
             passenger->setIsSick(true);
-            std::cout << "Passenger " << (index + 1) << " is SICK!" << std::endl;
+            if (config.verbose) {
+                std::cout << "Passenger " << (index + 1) << " is SICK!\n";
+            }
 
             // TODO: Render sick passenger with green color
             // TODO: If this is the camera passenger, apply green screen filter
 
             // Start slowing down
-            wagon.setDeceleration(SLOWDOWN_DECELERATION);
+            wagon.setDeceleration(config.slowdownDeceleration);
             gameState = GameState::SLOWDOWN;
-            std::cout << "STATE: SLOWDOWN" << std::endl;
+            if (config.verbose) {
+                std::cout << "STATE: SLOWDOWN\n";
+            }
         }
     }
 }
@@ -229,19 +292,25 @@ void RollerCoaster::handleStartRide() {
     }
 
     if (!hasPassengers()) {
-        std::cout << "Cannot start: No passengers!" << std::endl;
+        if (config.verbose) {
+            std::cout << "Cannot start: No passengers!\n";
+        }
         return;
     }
 
     if (!allPassengersBuckled()) {
-        std::cout << "Cannot start: Not all passengers buckled!" << std::endl;
+        if (config.verbose) {
+            std::cout << "Cannot start: Not all passengers buckled!\n";
+        }
         return;
     }
 
     wagon.startRide();
-    passedMidpoint = false;  // Reset loop detection
+    wagon.watchSpeed(config.maxStartVelocity);
     gameState = GameState::TAKEOFF;
-    std::cout << "STATE: TAKEOFF" << std::endl;
+    if (config.verbose) {
+        std::cout << "STATE: TAKEOFF\n";
+    }
 }
 
 GameState RollerCoaster::getState() const {
@@ -249,17 +318,27 @@ GameState RollerCoaster::getState() const {
 }
 
 size_t RollerCoaster::getPassengerCount() const {
-    return passengers.size();
-}
-
-const std::vector<Person>& RollerCoaster::getPassengers() const {
-    return passengers;
+    return passengerCount;
 }
 
 bool RollerCoaster::isSeatOccupied(int seatIndex) const {
-    return findPassengerBySeat(seatIndex) != nullptr;
+    if (seatIndex < 0 || seatIndex >= seatCount) {
+        return false;
+    }
+    return (occupied[seatIndex / BITS_PER_WORD] >> (seatIndex % BITS_PER_WORD)) & 1;
 }
 
 const Person* RollerCoaster::getPassengerBySeat(int seatIndex) const {
     return findPassengerBySeat(seatIndex);
 }
+
+uint64_t RollerCoaster::hashState(uint64_t seed) const {
+    uint64_t hash = hashBytes(&gameState, sizeof(gameState), seed);
+    hash = hashBytes(&cooldownTimer, sizeof(cooldownTimer), hash);
+    for (int seat = nextPassengerSeat(0); seat >= 0; seat = nextPassengerSeat(seat + 1)) {
+        const Person& p = seats[seat];
+        int32_t passenger[3] = { p.getSeatIndex(), p.getHasSeatbelt(), p.getIsSick() };
+        hash = hashBytes(passenger, sizeof(passenger), hash);
+    }
+    return hash;
+}
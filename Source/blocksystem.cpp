@@ -0,0 +1,418 @@
+#include "../Header/blocksystem.hpp"
+#include "../Header/threadpool.hpp"
+#include "../Header/trackpath.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+// Distance in [0, length)
+float wrapDistance(float distance, float length)
+{
+    if (distance >= length)
+    {
+        distance -= length;
+    }
+    else if (distance < 0.0f)
+    {
+        distance += length;
+    }
+    return distance;
+}
+
+// How far short of a block boundary an emergency stop puts the train, in world units
+const float BOUNDARY_CLEARANCE = 0.01f;
+
+} // namespace
+
+BlockSystem::BlockSystem()
+    : trackLength(0.0f), occupancyWords(0), ready(false), emergencyStops(0)
+{
+}
+
+bool BlockSystem::setBlocks(const std::vector<TrackBlock>& layout, float length)
+{
+    blocks.clear();
+    tailBlock.clear();
+    lastBlock.clear();
+    occupancy.reset();
+    occupancyWords = 0;
+    ready = false;
+    trackLength = length;
+
+    if (layout.empty() || length <= 0.0f)
+    {
+        std::cerr << "BlockSystem: No blocks or empty track" << std::endl;
+        return false;
+    }
+
+    std::vector<TrackBlock> sorted = layout;
+    std::sort(sorted.begin(), sorted.end(), [](const TrackBlock& a, const TrackBlock& b)
+    {
+        return a.begin < b.begin;
+    });
+
+    float tolerance = length * 1e-5f;
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        float expectedEnd = i + 1 < sorted.size() ? sorted[i + 1].begin : sorted[0].begin + length;
+        if (sorted[i].begin < 0.0f || sorted[i].begin >= length ||
+            sorted[i].end <= sorted[i].begin || std::abs(sorted[i].end - expectedEnd) > tolerance)
+        {
+            std::cerr << "BlockSystem: Blocks must tile the track, block " << i << " is ["
+                      << sorted[i].begin << ", " << sorted[i].end << ")" << std::endl;
+            return false;
+        }
+        sorted[i].end = expectedEnd;
+    }
+
+    blocks = sorted;
+    occupancyWords = (blocks.size() + 63) / 64;
+    occupancy.reset(new std::atomic<uint64_t>[occupancyWords]);
+    for (size_t w = 0; w < occupancyWords; ++w)
+    {
+        occupancy[w].store(0, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+std::vector<TrackBlock> BlockSystem::evenBlocks(float length, size_t count)
+{
+    std::vector<TrackBlock> layout(std::max<size_t>(count, 1));
+    float blockLength = length / layout.size();
+    for (size_t i = 0; i < layout.size(); ++i)
+    {
+        layout[i].begin = i * blockLength;
+        layout[i].end = i + 1 < layout.size() ? (i + 1) * blockLength : length;
+    }
+    return layout;
+}
+
+uint32_t BlockSystem::blockAt(float distance) const
+{
+    if (distance < blocks[0].begin)
+    {
+        distance += trackLength;
+    }
+    auto it = std::upper_bound(blocks.begin(), blocks.end(), distance, [](float d, const TrackBlock& block)
+    {
+        return d < block.begin;
+    });
+    return static_cast<uint32_t>(it - blocks.begin()) - 1;
+}
+
+uint32_t BlockSystem::blockNear(uint32_t hint, float distance) const
+{
+    // Trains move a few blocks per tick at most, so a short walk forward from the hint usually
+    // finds the block before a search would
+    if (distance < blocks[0].begin)
+    {
+        distance += trackLength;
+    }
+    uint32_t b = hint;
+    for (int i = 0; i < 8; ++i)
+    {
+        if (distance >= blocks[b].begin && distance < blocks[b].end)
+        {
+            return b;
+        }
+        b = nextBlock(b);
+    }
+    return blockAt(distance);
+}
+
+uint32_t BlockSystem::blocksAhead(uint32_t a, uint32_t b) const
+{
+    return b >= a ? b - a : b + static_cast<uint32_t>(blocks.size()) - a;
+}
+
+bool BlockSystem::claim(uint32_t block)
+{
+    // Held trains retry every tick; a plain load keeps them off the cache line's write path
+    uint64_t bit = uint64_t(1) << (block & 63);
+    if (occupancy[block >> 6].load(std::memory_order_relaxed) & bit)
+    {
+        return false;
+    }
+    return (occupancy[block >> 6].fetch_or(bit, std::memory_order_acq_rel) & bit) == 0;
+}
+
+void BlockSystem::release(uint32_t block)
+{
+    uint64_t bit = uint64_t(1) << (block & 63);
+    occupancy[block >> 6].fetch_and(~bit, std::memory_order_release);
+}
+
+bool BlockSystem::isOccupied(size_t block) const
+{
+    uint64_t bit = uint64_t(1) << (block & 63);
+    return (occupancy[block >> 6].load(std::memory_order_acquire) & bit) != 0;
+}
+
+size_t BlockSystem::occupiedCount() const
+{
+    size_t count = 0;
+    for (size_t w = 0; w < occupancyWords; ++w)
+    {
+        uint64_t word = occupancy[w].load(std::memory_order_relaxed);
+        while (word)
+        {
+            word &= word - 1;
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool BlockSystem::reset(TrainSystem& trains, const TrackPath& path)
+{
+    size_t n = trains.size();
+    tailBlock.assign(n, 0);
+    lastBlock.assign(n, 0);
+    emergencyStops.store(0, std::memory_order_relaxed);
+    ready = false;
+    if (blocks.empty())
+    {
+        return false;
+    }
+    for (size_t w = 0; w < occupancyWords; ++w)
+    {
+        occupancy[w].store(0, std::memory_order_relaxed);
+    }
+
+    float length = path.getLength();
+    bool ok = true;
+    for (size_t i = 0; i < n; ++i)
+    {
+        float head = trains.getTrackParameter(i) * length;
+        uint32_t tail = blockAt(wrapDistance(head - params.trainLength, length));
+        uint32_t last = blockAt(head);
+        tailBlock[i] = tail;
+        lastBlock[i] = last;
+
+        for (uint32_t b = tail;; b = nextBlock(b))
+        {
+            if (!claim(b))
+            {
+                std::cerr << "BlockSystem: Train " << i << " placed in occupied block " << b << std::endl;
+                ok = false;
+            }
+            if (b == last)
+            {
+                break;
+            }
+        }
+    }
+    ready = ok;
+    return ok;
+}
+
+void BlockSystem::update(TrainSystem& trains, const TrackPath& path, float deltaTime, bool parallel)
+{
+    size_t n = trains.size();
+    if (n == 0 || !ready || tailBlock.size() != n || !path.isInitialized())
+    {
+        return;
+    }
+
+    float length = path.getLength();
+    uint64_t stopsBefore = emergencyStops.load(std::memory_order_relaxed);
+    if (parallel)
+    {
+        trains.forEachRange(TrainSystem::PARALLEL_GRAIN, [&](size_t begin, size_t end)
+        {
+            updateRange(trains, length, deltaTime, begin, end);
+        });
+    }
+    else
+    {
+        updateRange(trains, length, deltaTime, 0, n);
+    }
+
+    // Emergency stops moved trains; their frames are refreshed once, after every range is done
+    if (emergencyStops.load(std::memory_order_relaxed) != stopsBefore)
+    {
+        trains.invalidateFrames();
+    }
+}
+
+void BlockSystem::emergencyStop(TrainSystem& trains, size_t i, float head, float length)
+{
+    trains.moveTrain(i, wrapDistance(head, length) / length);
+    trains.setVelocity(i, 0.0f);
+    trains.setState(i, TrainSystem::State::HOLDING);
+    emergencyStops.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BlockSystem::updateRange(TrainSystem& trains, float length, float deltaTime, size_t begin, size_t end)
+{
+    using State = TrainSystem::State;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        State state = trains.getState(i);
+        float head = trains.getTrackParameter(i) * length;
+        float speed = trains.getVelocity(i) * length;
+        uint32_t tail = tailBlock[i];
+        uint32_t last = lastBlock[i];
+
+        uint32_t tailNeeded = blockNear(tail, wrapDistance(head - params.trainLength, length));
+        uint32_t headNeeded = blockNear(tailNeeded, head);
+
+        if (speed < 0.0f)
+        {
+            // Reversing: extend the run backward under the tail; the blocks ahead stay held
+            while (tail != tailNeeded && blocksAhead(tail, tailNeeded) > blocksAhead(tail, last) &&
+                   claim(previousBlock(tail)))
+            {
+                tail = previousBlock(tail);
+            }
+            if (blocksAhead(tail, tailNeeded) > blocksAhead(tail, last))
+            {
+                emergencyStop(trains, i, blocks[tail].begin + params.trainLength + BOUNDARY_CLEARANCE, length);
+            }
+            tailBlock[i] = tail;
+            continue;
+        }
+
+        // Moved past the end of the run: the block should have been claimed ahead of time
+        if (blocksAhead(tail, headNeeded) > blocksAhead(tail, last))
+        {
+            while (last != headNeeded && nextBlock(last) != tail && claim(nextBlock(last)))
+            {
+                last = nextBlock(last);
+            }
+            if (last != headNeeded)
+            {
+                head = wrapDistance(blocks[last].end - BOUNDARY_CLEARANCE, length);
+                emergencyStop(trains, i, head, length);
+                state = State::HOLDING;
+                speed = 0.0f;
+                tailNeeded = blockAt(wrapDistance(head - params.trainLength, length));
+            }
+        }
+
+        // Release the blocks the tail has left
+        if (blocksAhead(tail, tailNeeded) <= blocksAhead(tail, last))
+        {
+            while (tail != tailNeeded)
+            {
+                release(tail);
+                tail = nextBlock(tail);
+            }
+        }
+
+        if (state != State::STOPPED)
+        {
+            // Claim ahead so the run always reaches past the braking distance
+            float stopping = speed * speed / (2.0f * params.brakeDeceleration) + params.safetyMargin + speed * deltaTime;
+            float toEnd = wrapDistance(blocks[last].end - head, length);
+
+            bool needBlock = toEnd < stopping || state == State::HOLDING;
+            bool claimed = false;
+            while (needBlock && nextBlock(last) != tail && claim(nextBlock(last)))
+            {
+                last = nextBlock(last);
+                toEnd += blocks[last].end - blocks[last].begin;
+                claimed = true;
+                needBlock = toEnd < stopping;
+            }
+
+            if (needBlock)
+            {
+                // The block ahead is held: stop before the end of the run
+                if (state != State::HOLDING && speed > 0.0f)
+                {
+                    float available = std::max(toEnd - params.safetyMargin, BOUNDARY_CLEARANCE);
+                    float decel = std::max(params.brakeDeceleration, speed * speed / (2.0f * available));
+                    trains.setState(i, State::BRAKING);
+                    trains.setAcceleration(i, -decel / length);
+                }
+            }
+            else if (claimed && state == State::BRAKING)
+            {
+                trains.setState(i, State::RUNNING);
+            }
+            else if (claimed && state == State::HOLDING)
+            {
+                trains.setState(i, State::STARTING);
+            }
+        }
+
+        tailBlock[i] = tail;
+        lastBlock[i] = last;
+    }
+}
+
+void benchmarkBlockSystem(const TrackPath& path)
+{
+    if (!path.isInitialized())
+    {
+        return;
+    }
+
+    const int steps = 240;
+    const float dt = 1.0f / 240.0f;
+    const size_t counts[] = { 10, 100, 1000, 10000 };
+    const size_t blocksPerTrain = 8;
+    float length = path.getLength();
+    WorkStealingPool pool;
+
+    // The layout scales with the train count so the trains keep moving: each one is a block long,
+    // travels half its spacing per second at constant speed and brakes to a stop within one block
+    std::cout << "BlockSystem: " << steps << " steps per run, " << blocksPerTrain
+              << " blocks per train, trains at half their spacing per second" << std::endl;
+    for (size_t count : counts)
+    {
+        float spacing = length / count;
+        float block = spacing / blocksPerTrain;
+        float speed = 0.5f * spacing;
+
+        BlockSystem blockSystem;
+        blockSystem.setBlocks(BlockSystem::evenBlocks(length, count * blocksPerTrain), length);
+        BlockParams& params = blockSystem.getParams();
+        params.trainLength = 0.9f * block;
+        params.safetyMargin = 0.25f * block;
+        params.brakeDeceleration = speed * speed / (2.0f * block);
+
+        TrainSystem trains;
+        trains.setPool(&pool);
+        for (size_t i = 0; i < count; ++i)
+        {
+            trains.addTrain(static_cast<float>(i) / count, TrainSystem::State::CONSTANT, speed / length);
+        }
+        blockSystem.reset(trains, path);
+
+        double blockSeconds = 0.0, stepSeconds = 0.0;
+        for (int s = 0; s < steps; ++s)
+        {
+            auto start = std::chrono::steady_clock::now();
+            blockSystem.update(trains, path, dt);
+            auto mid = std::chrono::steady_clock::now();
+            trains.step(path, dt);
+            auto stop = std::chrono::steady_clock::now();
+            blockSeconds += std::chrono::duration<double>(mid - start).count();
+            stepSeconds += std::chrono::duration<double>(stop - mid).count();
+        }
+
+        size_t held = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            TrainSystem::State state = trains.getState(i);
+            if (state == TrainSystem::State::BRAKING || state == TrainSystem::State::HOLDING)
+            {
+                ++held;
+            }
+        }
+
+        std::cout << "  " << count << " trains: " << blockSeconds * 1e6 / steps << " us/tick for blocks ("
+                  << blockSeconds * 1e9 / (static_cast<double>(count) * steps) << " ns/train), "
+                  << stepSeconds * 1e6 / steps << " us/tick for the step, "
+                  << count - held << " moving, " << held << " braking or held, "
+                  << blockSystem.getEmergencyStops() << " emergency stops" << std::endl;
+    }
+}
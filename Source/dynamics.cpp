@@ -0,0 +1,195 @@
+#include "../Header/dynamics.hpp"
+#include "../Header/trackpath.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+TrainDynamics::TrainDynamics(const TrainDynamicsParams& params)
+    : params(params)
+{
+}
+
+float TrainDynamics::getTrackLength(const TrackPath& path) const
+{
+    return path.getLength() * params.metresPerUnit;
+}
+
+double TrainDynamics::wrapDistance(double distance, double length)
+{
+    if (length <= 0.0)
+    {
+        return 0.0;
+    }
+    distance = std::fmod(distance, length);
+    return distance < 0.0 ? distance + length : distance;
+}
+
+bool TrainDynamics::inZone(const TrackZone& zone, double distance)
+{
+    if (zone.begin <= zone.end)
+    {
+        return distance >= zone.begin && distance < zone.end;
+    }
+    return distance >= zone.begin || distance < zone.end;
+}
+
+void TrainDynamics::derivatives(const TrackPath& path, double distance, float speed, float chainSpeed,
+                                float& acceleration, float& power) const
+{
+    double length = getTrackLength(path);
+    double s = wrapDistance(distance, length);
+
+    // Every car weighs the same, so the train feels the mean slope of its cars
+    int cars = std::max(params.carCount, 1);
+    float slope = 0.0f;
+    float cosPitch = 0.0f;
+    for (int i = 0; i < cars; ++i)
+    {
+        double carDistance = wrapDistance(s - static_cast<double>(i) * params.carSpacing, length);
+        float carSlope = path.getForwardAtDistance(static_cast<float>(carDistance / params.metresPerUnit)).y;
+        slope += carSlope;
+        cosPitch += std::sqrt(std::max(0.0f, 1.0f - carSlope * carSlope));
+    }
+    slope /= cars;
+    cosPitch /= cars;
+    float mass = params.mass * cars;
+
+    // Gravity along the tangent is the only conservative force
+    float gravityAccel = -params.gravity * slope;
+
+    // Smooth sign of the speed so resistance fades out instead of chattering at rest
+    float direction = speed / (std::abs(speed) + 0.01f);
+
+    float force = -0.5f * params.airDensity * params.dragArea * speed * std::abs(speed);
+    force -= params.rollingResistance * mass * params.gravity * cosPitch * direction;
+
+    // Lifts hold their speed against gravity and resistance, brakes only take away overspeed
+    float response = mass / std::max(params.speedResponse, 1e-3f);
+    float holdForce = mass * params.gravity * slope - force;
+    if (chainSpeed > 0.0f)
+    {
+        float pull = response * (chainSpeed - speed) + holdForce;
+        force += std::min(std::max(pull, 0.0f), params.chainForce);
+    }
+    for (const TrackZone& zone : params.zones)
+    {
+        if (!inZone(zone, s))
+        {
+            continue;
+        }
+
+        if (zone.type == TrackZone::Type::LIFT)
+        {
+            float pull = response * (zone.targetSpeed - speed) + holdForce;
+            force += std::min(std::max(pull, 0.0f), zone.maxForce);
+        }
+        else if (std::abs(speed) > zone.targetSpeed)
+        {
+            force -= direction * std::min(zone.maxForce, response * (std::abs(speed) - zone.targetSpeed));
+        }
+    }
+
+    acceleration = gravityAccel + force / mass;
+    power = force * speed;
+}
+
+void TrainDynamics::step(const TrackPath& path, DynamicsState& state, float dt) const
+{
+    double s = state.distance;
+    float v = state.speed;
+    float c = state.chainSpeed;
+
+    float a1, p1, a2, p2, a3, p3, a4, p4;
+    derivatives(path, s, v, c, a1, p1);
+    derivatives(path, s + 0.5 * dt * v, v + 0.5f * dt * a1, c, a2, p2);
+    float v2 = v + 0.5f * dt * a1;
+    derivatives(path, s + 0.5 * dt * v2, v + 0.5f * dt * a2, c, a3, p3);
+    float v3 = v + 0.5f * dt * a2;
+    derivatives(path, s + dt * v3, v + dt * a3, c, a4, p4);
+    float v4 = v + dt * a3;
+
+    state.distance = wrapDistance(s + dt / 6.0 * (v + 2.0f * v2 + 2.0f * v3 + v4), getTrackLength(path));
+    state.speed = v + dt / 6.0f * (a1 + 2.0f * a2 + 2.0f * a3 + a4);
+    state.work += dt / 6.0 * (p1 + 2.0f * p2 + 2.0f * p3 + p4);
+}
+
+double TrainDynamics::totalEnergy(const TrackPath& path, const DynamicsState& state) const
+{
+    double length = getTrackLength(path);
+    int cars = std::max(params.carCount, 1);
+
+    double potential = 0.0;
+    for (int i = 0; i < cars; ++i)
+    {
+        double carDistance = wrapDistance(state.distance - static_cast<double>(i) * params.carSpacing, length);
+        float height = path.getPositionAtDistance(static_cast<float>(carDistance / params.metresPerUnit)).y * params.metresPerUnit;
+        potential += static_cast<double>(params.mass) * params.gravity * height;
+    }
+
+    double kinetic = 0.5 * params.mass * cars * state.speed * state.speed;
+    return kinetic + potential - state.work;
+}
+
+void TrainDynamics::setRideZones(const TrackPath& path, float lapEndT, float liftSpeed, float brakeSpeed)
+{
+    params.zones.clear();
+    float length = getTrackLength(path);
+    if (length <= 0.0f)
+    {
+        return;
+    }
+
+    // Longest stretch climbing at LIFT_MIN_SLOPE or more, sampled every metre around the track
+    // from a point that is not climbing, so no stretch is split at the start
+    int samples = std::max(static_cast<int>(length), 2);
+    float spacing = length / samples;
+    auto climbing = [&](int i) {
+        double distance = wrapDistance(static_cast<double>(i) * spacing, length);
+        return path.getForwardAtDistance(static_cast<float>(distance / params.metresPerUnit)).y >= LIFT_MIN_SLOPE;
+    };
+
+    int origin = 0;
+    while (origin < samples && climbing(origin))
+    {
+        ++origin;
+    }
+    int bestStart = 0, bestLength = 0, runStart = 0, runLength = 0;
+    for (int i = origin; origin < samples && i <= origin + samples; ++i)
+    {
+        if (i < origin + samples && climbing(i))
+        {
+            if (runLength == 0)
+            {
+                runStart = i;
+            }
+            ++runLength;
+            continue;
+        }
+        if (runLength > bestLength)
+        {
+            bestStart = runStart;
+            bestLength = runLength;
+        }
+        runLength = 0;
+    }
+
+    float trainMass = params.mass * std::max(params.carCount, 1);
+    if (bestLength > 0)
+    {
+        TrackZone lift;
+        lift.type = TrackZone::Type::LIFT;
+        lift.begin = static_cast<float>(wrapDistance(bestStart * spacing, length));
+        lift.end = static_cast<float>(wrapDistance((bestStart + bestLength) * spacing, length));
+        lift.targetSpeed = liftSpeed * length;
+        lift.maxForce = params.chainForce;
+        params.zones.push_back(lift);
+    }
+
+    TrackZone brake;
+    brake.type = TrackZone::Type::BRAKE;
+    brake.end = static_cast<float>(wrapDistance(static_cast<double>(lapEndT) * length, length));
+    brake.begin = static_cast<float>(wrapDistance(brake.end - std::min(BRAKE_RUN, 0.25f * length), length));
+    brake.targetSpeed = std::abs(brakeSpeed) * length;
+    brake.maxForce = trainMass * BRAKE_DECELERATION;
+    params.zones.push_back(brake);
+}
@@ -0,0 +1,619 @@
+// Headless ride simulation: no window, no GL context
+// Loads the track from the path cache (or imports the OBJ), then drives RollerCoaster with
+// scripted inputs as fast as the CPU allows and prints ride statistics.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../Header/blocksystem.hpp"
+#include "../Header/dynamics.hpp"
+#include "../Header/objloader.hpp"
+#include "../Header/parallel.hpp"
+#include "../Header/session.hpp"
+#include "../Header/stationsim.hpp"
+#include "../Header/sweep.hpp"
+#include "../Header/telemetry.hpp"
+#include "../Header/trackpath.hpp"
+#include "../Header/trainsystem.hpp"
+#include "../Header/wagonstate.hpp"
+#include "../Header/Game/Constants.hpp"
+#include "../Header/Game/RollerCoaster.hpp"
+
+namespace
+{
+
+struct Options
+{
+    std::string trackObj = "res/track.obj";
+    std::string trackCache = "res/track.pathcache";
+    int rides = 10;
+    int cars = 3;
+    bool physical = false;
+    bool energyCheck = false;
+    float sickAfter = 0.0f;   // Seconds into the ride when seat 1 feels sick, 0 for never
+    float maxRideTime = 600.0f;
+
+    // Station throughput mode (--station), timed with the ride cycle measured on this track
+    bool station = false;
+    int replications = 0;   // 0 for one per hardware thread
+    StationConfig stationConfig;
+
+    // Parameter sweep mode (--sweep), one ride per combination of the ranges
+    std::vector<SweepRange> sweepRanges;
+    std::string sweepPath = "sweep.csv";
+    unsigned int threads = 0;   // 0 for one per hardware thread
+
+    bool benchTrains = false;
+    bool benchBlocks = false;
+    bool benchFrames = false;
+    bool benchBatch = false;
+    bool benchExtract = false;
+
+    // Session journal written after the scripted rides, or played back instead of them
+    std::string recordPath;
+    std::string replayPath;
+
+    std::string telemetryPath;  // Per-seat G-forces and jerk of every tick
+};
+
+void printUsage()
+{
+    std::cout << "Usage: rollercoaster_headless [options]" << std::endl;
+    std::cout << "  --track FILE       Track mesh (default res/track.obj)" << std::endl;
+    std::cout << "  --cache FILE       Path cache (default res/track.pathcache)" << std::endl;
+    std::cout << "  --rides N          Rides to simulate (default 10)" << std::endl;
+    std::cout << "  --cars N           Cars per train (default 3)" << std::endl;
+    std::cout << "  --physical         Use the physical dynamics model" << std::endl;
+    std::cout << "  --energy-check     Ride one lap with the physical model and report the energy drift" << std::endl;
+    std::cout << "  --sick-after S     A passenger gets sick S seconds into every ride" << std::endl;
+    std::cout << "  --record FILE      Save a journal of the rides" << std::endl;
+    std::cout << "  --telemetry FILE   Write per-seat G-force and jerk telemetry" << std::endl;
+    std::cout << "  --replay FILE      Replay a journal recorded here or in the game, and check every tick" << std::endl;
+    std::cout << "Station throughput mode:" << std::endl;
+    std::cout << "  --station HOURS    Simulate HOURS of operation per replication instead of single rides" << std::endl;
+    std::cout << "  --replications N   Independent replications (default one per thread)" << std::endl;
+    std::cout << "  --arrivals R       Riders arriving per hour (default 400)" << std::endl;
+    std::cout << "  --trains N         Trains in service (default 2)" << std::endl;
+    std::cout << "  --dispatch S       Shortest time between departures (default 30)" << std::endl;
+    std::cout << "  --sick-prob P      Chance per rider and ride of getting sick (default 0.002)" << std::endl;
+    std::cout << "  --seed N           Random seed (default 1)" << std::endl;
+    std::cout << "Parameter sweep mode:" << std::endl;
+    std::cout << "  --sweep NAME=FROM:TO:STEPS  Ride every value of a tuning parameter, repeat for a grid" << std::endl;
+    std::cout << "                     NAME is start_track_t, end_track_t, max_start_velocity," << std::endl;
+    std::cout << "                     slowdown_deceleration, reverse_velocity, cooldown_duration," << std::endl;
+    std::cout << "                     chain_lift_accel, cruise_speed, gravity_effect, friction," << std::endl;
+    std::cout << "                     min_velocity or max_velocity" << std::endl;
+    std::cout << "  --sweep-out FILE   Results as CSV (default sweep.csv)" << std::endl;
+    std::cout << "  --threads N        Worker threads (default one per hardware thread)" << std::endl;
+    std::cout << "Benchmarks:" << std::endl;
+    std::cout << "  --bench-trains     Batched train step, one thread against the pool, 1K to 100K trains" << std::endl;
+    std::cout << "  --bench-blocks     Block system overhead per tick as the train count grows" << std::endl;
+    std::cout << "  --bench-frames     Fused evaluateFrame against separate position and frame queries" << std::endl;
+    std::cout << "  --bench-batch      Batched frame throughput against the scalar path at 1K to 10M samples" << std::endl;
+    std::cout << "  --bench-extract    Track extraction and smoothing from 300 to 10M segments (needs no track)" << std::endl;
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--track") == 0 && hasValue)
+        {
+            options.trackObj = argv[++i];
+        }
+        else if (std::strcmp(arg, "--cache") == 0 && hasValue)
+        {
+            options.trackCache = argv[++i];
+        }
+        else if (std::strcmp(arg, "--rides") == 0 && hasValue)
+        {
+            options.rides = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(arg, "--cars") == 0 && hasValue)
+        {
+            options.cars = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(arg, "--physical") == 0)
+        {
+            options.physical = true;
+        }
+        else if (std::strcmp(arg, "--energy-check") == 0)
+        {
+            options.energyCheck = true;
+        }
+        else if (std::strcmp(arg, "--sick-after") == 0 && hasValue)
+        {
+            options.sickAfter = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (std::strcmp(arg, "--station") == 0 && hasValue)
+        {
+            options.station = true;
+            options.stationConfig.hours = std::max(0.0, std::atof(argv[++i]));
+        }
+        else if (std::strcmp(arg, "--replications") == 0 && hasValue)
+        {
+            options.replications = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(arg, "--arrivals") == 0 && hasValue)
+        {
+            options.stationConfig.arrivalRate = std::max(1e-3, std::atof(argv[++i]));
+        }
+        else if (std::strcmp(arg, "--trains") == 0 && hasValue)
+        {
+            options.stationConfig.trains = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(arg, "--dispatch") == 0 && hasValue)
+        {
+            options.stationConfig.dispatchInterval = std::max(0.0, std::atof(argv[++i]));
+        }
+        else if (std::strcmp(arg, "--sick-prob") == 0 && hasValue)
+        {
+            options.stationConfig.sickProbability = std::min(std::max(std::atof(argv[++i]), 0.0), 1.0);
+        }
+        else if (std::strcmp(arg, "--seed") == 0 && hasValue)
+        {
+            options.stationConfig.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(arg, "--record") == 0 && hasValue)
+        {
+            options.recordPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--telemetry") == 0 && hasValue)
+        {
+            options.telemetryPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--replay") == 0 && hasValue)
+        {
+            options.replayPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--sweep") == 0 && hasValue)
+        {
+            SweepRange range;
+            if (!ParameterSweep::parseRange(argv[++i], range))
+            {
+                std::cerr << "Headless: Bad sweep range " << argv[i] << std::endl;
+                printUsage();
+                return false;
+            }
+            options.sweepRanges.push_back(range);
+        }
+        else if (std::strcmp(arg, "--sweep-out") == 0 && hasValue)
+        {
+            options.sweepPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--threads") == 0 && hasValue)
+        {
+            options.threads = static_cast<unsigned int>(std::max(1, std::atoi(argv[++i])));
+        }
+        else if (std::strcmp(arg, "--bench-trains") == 0)
+        {
+            options.benchTrains = true;
+        }
+        else if (std::strcmp(arg, "--bench-blocks") == 0)
+        {
+            options.benchBlocks = true;
+        }
+        else if (std::strcmp(arg, "--bench-frames") == 0)
+        {
+            options.benchFrames = true;
+        }
+        else if (std::strcmp(arg, "--bench-batch") == 0)
+        {
+            options.benchBatch = true;
+        }
+        else if (std::strcmp(arg, "--bench-extract") == 0)
+        {
+            options.benchExtract = true;
+        }
+        else
+        {
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Same cache and extraction settings as the game, so both share one cache file
+bool loadTrack(const Options& options, TrackPath& trackPath, uint64_t& key)
+{
+    if (trackPath.loadFromCache(options.trackCache, options.trackObj, key, 300, 384))
+    {
+        std::cout << "Track path loaded from cache" << std::endl;
+        return true;
+    }
+
+    key = TrackPath::computeCacheKey(options.trackObj, 300, 384);
+    std::vector<glm::vec3> corners;
+    float edgeLength = 0.0f;
+    if (!loadObjTriangles(options.trackObj, corners, edgeLength))
+    {
+        return false;
+    }
+
+    trackPath.extractFromVertices(corners, edgeLength, 300, 384);
+    if (!trackPath.isInitialized())
+    {
+        return false;
+    }
+    trackPath.saveToCache(options.trackCache, options.trackObj, key, 300, 384);
+    return true;
+}
+
+// Run a recorded session as fast as possible and check it tick by tick
+int runReplay(Session& session, const SessionJournal& journal, uint64_t trackKey)
+{
+    if (!session.startReplay(journal, trackKey))
+    {
+        return 1;
+    }
+
+    auto wallStart = std::chrono::steady_clock::now();
+    while (session.isReplaying())
+    {
+        session.tick();
+    }
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+
+    double simSeconds = session.getTick() * static_cast<double>(SIM_TIMESTEP);
+    std::cout << std::endl << "Replay" << std::endl;
+    std::cout << "  Ticks:          " << session.getTick() << " (" << simSeconds << " s)" << std::endl;
+    std::cout << "  Wall time:      " << wall.count() * 1000.0 << " ms ("
+              << (wall.count() > 0.0 ? wall.count() * 1e9 / session.getTick() : 0.0) << " ns per tick)" << std::endl;
+    if (session.getFirstMismatch() >= 0)
+    {
+        std::cout << "  Result:         diverged at tick " << session.getFirstMismatch() << std::endl;
+        return 1;
+    }
+    std::cout << "  Result:         identical" << std::endl;
+    return 0;
+}
+
+struct RideResult
+{
+    double duration;      // Seconds from start to the wagon back in the station
+    float peakSpeed;      // World units per second
+    bool sick;
+};
+
+// Measure the ride cycle on the track, then run the station model on every core
+int runStation(const Options& options, const TrackPath& trackPath, WagonState& wagon)
+{
+    auto calibrateStart = std::chrono::steady_clock::now();
+    RideTimings timings = StationSimulator::calibrate(trackPath, wagon);
+    std::chrono::duration<double> calibrateTime = std::chrono::steady_clock::now() - calibrateStart;
+    std::cout << "Ride cycle: " << timings.rideTime << " s, sick window " << timings.sickWindow
+              << " s (measured in " << calibrateTime.count() * 1000.0 << " ms)" << std::endl;
+
+    StationConfig config = options.stationConfig;
+    config.seatsPerTrain = wagon.getCarCount() * WagonState::SEATS_PER_CAR;
+    int replications = options.replications > 0 ? options.replications : static_cast<int>(workerCount());
+
+    StationSimulator simulator(config, timings);
+    auto wallStart = std::chrono::steady_clock::now();
+    StationStats stats = simulator.run(replications);
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+
+    std::cout << std::endl;
+    StationSimulator::printStats(stats);
+    std::cout << "  Replications:   " << replications << " on " << workerCount() << " threads in "
+              << wall.count() * 1000.0 << " ms" << std::endl;
+    return 0;
+}
+
+// Largest energy drift the check accepts, as a fraction of the peak kinetic energy
+const double ENERGY_TOLERANCE = 0.01;
+
+// Ride one lap from the station with the physical model, lifts and brakes included, and check that
+// kinetic plus potential energy minus the work done stays constant up to integration error
+int runEnergyCheck(const Options& options, const TrackPath& trackPath, const TrainDynamics& dynamics,
+                   const WagonState& wagon)
+{
+    RideConfig ride;
+    const TrainDynamicsParams& params = dynamics.getParams();
+    double length = dynamics.getTrackLength(trackPath);
+    float cruise = wagon.getArcadeParams().cruiseSpeed * static_cast<float>(length);
+    double trainMass = static_cast<double>(params.mass) * std::max(params.carCount, 1);
+
+    for (const TrackZone& zone : params.zones)
+    {
+        std::cout << (zone.type == TrackZone::Type::LIFT ? "Lift:  " : "Brake: ") << zone.begin << " to "
+                  << zone.end << " m, " << zone.targetSpeed << " m/s" << std::endl;
+    }
+
+    // The station chain pulls up to cruise speed like in the game, then the train runs free
+    DynamicsState state;
+    state.distance = ride.startTrackT * length;
+    state.speed = 0.0f;
+    state.work = 0.0;
+    state.chainSpeed = cruise;
+
+    double lap = ride.endTrackT - ride.startTrackT;
+    lap = (lap <= 0.0 ? lap + 1.0 : lap) * length;
+    double initial = dynamics.totalEnergy(trackPath, state);
+    double travelled = 0.0, time = 0.0, maxDrift = 0.0, peakKinetic = 0.0;
+    float peakSpeed = 0.0f;
+    while (travelled < lap && time < options.maxRideTime)
+    {
+        double before = state.distance;
+        dynamics.step(trackPath, state, SIM_TIMESTEP);
+        time += SIM_TIMESTEP;
+        if (state.chainSpeed > 0.0f && state.speed >= cruise * 0.999f)
+        {
+            state.chainSpeed = 0.0f;
+        }
+
+        double moved = state.distance - before;
+        moved -= length * std::floor(moved / length + 0.5);
+        travelled += moved;
+
+        maxDrift = std::max(maxDrift, std::abs(dynamics.totalEnergy(trackPath, state) - initial));
+        peakKinetic = std::max(peakKinetic, 0.5 * trainMass * state.speed * state.speed);
+        peakSpeed = std::max(peakSpeed, state.speed);
+        if (state.chainSpeed == 0.0f && state.speed <= 0.0f)
+        {
+            break;  // Rolled back short of the lap marker
+        }
+    }
+
+    bool completed = travelled >= lap;
+    std::cout << "Energy check: " << (completed ? "lap of " : "stalled after ") << travelled << " m in " << time
+              << " s, peak " << peakSpeed << " m/s" << std::endl;
+    std::cout << "  Work done:      " << state.work / 1000.0 << " kJ by drag, rolling resistance, lifts and brakes" << std::endl;
+    double drift = peakKinetic > 0.0 ? maxDrift / peakKinetic : 0.0;
+    bool balanced = drift <= ENERGY_TOLERANCE;
+    std::cout << "  Energy drift:   " << maxDrift << " J at most, " << 100.0 * drift << "% of the peak kinetic energy" << std::endl;
+    std::cout << "  Result:         " << (balanced ? "within " : "outside ") << 100.0 * ENERGY_TOLERANCE << "%" << std::endl;
+    return completed && balanced ? 0 : 1;
+}
+
+// Ride every combination of the sweep ranges on all cores and write one CSV row per ride
+int runSweep(const Options& options, const TrackPath& trackPath, const WagonState& wagon, float metresPerUnit)
+{
+    SweepSettings settings;
+    settings.sickAfter = options.sickAfter;
+    settings.maxRideTime = options.maxRideTime;
+    settings.metresPerUnit = metresPerUnit;
+
+    ParameterSweep sweep(trackPath, wagon, settings);
+    for (const SweepRange& range : options.sweepRanges)
+    {
+        sweep.addRange(range);
+    }
+
+    unsigned int threads = options.threads > 0 ? options.threads : workerCount();
+    auto wallStart = std::chrono::steady_clock::now();
+    std::vector<SweepResult> results = sweep.run(threads);
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+
+    size_t completed = 0;
+    double simSeconds = 0.0;
+    const SweepResult* fastest = nullptr;
+    for (const SweepResult& r : results)
+    {
+        simSeconds += r.cycleTime;
+        if (r.completed)
+        {
+            ++completed;
+            if (!fastest || r.cycleTime < fastest->cycleTime)
+            {
+                fastest = &r;
+            }
+        }
+    }
+
+    std::cout << std::endl << "Parameter sweep" << std::endl;
+    std::cout << "  Model:          " << (options.physical ? "physical" : "arcade") << ", "
+              << wagon.getCarCount() << " cars" << std::endl;
+    std::cout << "  Configurations: " << results.size() << ", " << completed << " back in the station within "
+              << options.maxRideTime << " s" << std::endl;
+    if (fastest)
+    {
+        std::cout << "  Cycle time:     " << fastest->cycleTime << " s shortest (ride " << fastest->rideTime
+                  << " s, peak " << fastest->peakSpeed << " m/s)" << std::endl;
+    }
+    std::cout << "  Simulated:      " << simSeconds << " s of rides" << std::endl;
+    std::cout << "  Wall time:      " << wall.count() * 1000.0 << " ms on " << threads << " threads ("
+              << (wall.count() > 0.0 ? results.size() / wall.count() : 0.0) << " rides/s, "
+              << sweep.getStealCount() << " steals)" << std::endl;
+
+    return ParameterSweep::writeCsv(options.sweepPath, results) ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    if (options.benchExtract)
+    {
+        benchmarkTrackExtraction();
+        return 0;
+    }
+
+    SessionJournal journal;
+    if (!options.replayPath.empty())
+    {
+        if (!journal.load(options.replayPath))
+        {
+            return 1;
+        }
+        options.cars = static_cast<int>(journal.carCount);
+    }
+
+    TrackPath trackPath;
+    uint64_t trackKey = 0;
+    if (!loadTrack(options, trackPath, trackKey))
+    {
+        std::cerr << "Headless: No track available" << std::endl;
+        return 1;
+    }
+
+    if (options.benchTrains)
+    {
+        benchmarkTrainSystem(trackPath);
+        return 0;
+    }
+
+    if (options.benchBlocks)
+    {
+        benchmarkBlockSystem(trackPath);
+        return 0;
+    }
+
+    if (options.benchFrames)
+    {
+        benchmarkFrameEvaluation(trackPath);
+        return 0;
+    }
+
+    if (options.benchBatch)
+    {
+        benchmarkBatchEvaluation(trackPath);
+        return 0;
+    }
+
+    WagonState wagon(8.0f, 5.0f, 14.0f);  // Same body as the game's wagon
+    wagon.setHeightOffset(3.5f);
+    wagon.setCarCount(options.cars);
+
+    TrainDynamics dynamics;
+    dynamics.getParams().carCount = wagon.getCarCount();
+    dynamics.getParams().carSpacing = wagon.getCarSpacing() * dynamics.getParams().metresPerUnit;
+    RideConfig ride;
+    dynamics.setRideZones(trackPath, ride.endTrackT, wagon.getArcadeParams().cruiseSpeed, ride.reverseVelocity);
+    if (options.physical)
+    {
+        wagon.setDynamics(&dynamics);
+    }
+
+    if (options.energyCheck)
+    {
+        return runEnergyCheck(options, trackPath, dynamics, wagon);
+    }
+
+    if (options.station)
+    {
+        return runStation(options, trackPath, wagon);
+    }
+    if (!options.sweepRanges.empty())
+    {
+        return runSweep(options, trackPath, wagon, dynamics.getParams().metresPerUnit);
+    }
+
+    RollerCoaster game(wagon, trackPath);
+    Session session(game, wagon, trackPath, &dynamics);
+
+    Telemetry telemetry;
+    if (!options.telemetryPath.empty() && telemetry.start(options.telemetryPath, 1.0f / SIM_TIMESTEP, true))
+    {
+        session.setTelemetry(&telemetry);
+    }
+
+    if (!options.replayPath.empty())
+    {
+        return runReplay(session, journal, trackKey);
+    }
+    if (!options.recordPath.empty())
+    {
+        session.startRecording(trackKey);
+    }
+
+    std::vector<RideResult> results;
+    long long totalSteps = 0;
+    auto wallStart = std::chrono::steady_clock::now();
+
+    for (int ride = 0; ride < options.rides; ++ride)
+    {
+        // Fill the train, buckle everyone up and send it
+        for (int p = 0; p < game.getSeatCount(); ++p)
+        {
+            session.submit(SessionCommand::ADD_PASSENGER);
+            session.submit(SessionCommand::SEAT_ACTION, static_cast<uint16_t>(p));
+        }
+        session.submit(SessionCommand::START_RIDE);
+
+        RideResult result = { 0.0, 0.0f, false };
+        double rideTime = 0.0;
+        // The first tick applies the boarding inputs, so the game leaves OFFBOARDING only inside the loop
+        do
+        {
+            if (options.sickAfter > 0.0f && !result.sick && rideTime >= options.sickAfter &&
+                (game.getState() == GameState::RIDE || game.getState() == GameState::TAKEOFF))
+            {
+                session.submit(SessionCommand::SEAT_ACTION, 0);
+                result.sick = true;
+            }
+
+            session.tick();
+            rideTime += SIM_TIMESTEP;
+            ++totalSteps;
+
+            result.peakSpeed = std::max(result.peakSpeed, std::abs(wagon.getVelocity()) * trackPath.getLength());
+        } while (game.getState() != GameState::OFFBOARDING && rideTime < options.maxRideTime);
+        result.duration = rideTime;
+        results.push_back(result);
+
+        if (game.getState() != GameState::OFFBOARDING)
+        {
+            std::cerr << "Headless: Ride " << ride + 1 << " did not return within "
+                      << options.maxRideTime << " s" << std::endl;
+            break;
+        }
+
+        for (int p = 0; p < game.getSeatCount(); ++p)
+        {
+            session.submit(SessionCommand::SEAT_ACTION, static_cast<uint16_t>(p));
+        }
+    }
+
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart;
+    double simSeconds = totalSteps * static_cast<double>(SIM_TIMESTEP);
+
+    double minDuration = results.empty() ? 0.0 : results[0].duration;
+    double maxDuration = 0.0, sumDuration = 0.0;
+    float peakSpeed = 0.0f;
+    for (const RideResult& r : results)
+    {
+        minDuration = std::min(minDuration, r.duration);
+        maxDuration = std::max(maxDuration, r.duration);
+        sumDuration += r.duration;
+        peakSpeed = std::max(peakSpeed, r.peakSpeed);
+    }
+
+    std::cout << std::endl << "Ride statistics" << std::endl;
+    std::cout << "  Model:          " << (options.physical ? "physical" : "arcade") << ", "
+              << wagon.getCarCount() << " cars" << std::endl;
+    std::cout << "  Track length:   " << trackPath.getLength() << " units" << std::endl;
+    std::cout << "  Rides:          " << results.size() << std::endl;
+    if (!results.empty())
+    {
+        std::cout << "  Ride time:      " << sumDuration / results.size() << " s mean, "
+                  << minDuration << " s min, " << maxDuration << " s max" << std::endl;
+    }
+    std::cout << "  Peak speed:     " << peakSpeed << " units/s ("
+              << peakSpeed * dynamics.getParams().metresPerUnit << " m/s)" << std::endl;
+    std::cout << "  Simulated:      " << simSeconds << " s in " << totalSteps << " steps" << std::endl;
+    std::cout << "  Wall time:      " << wall.count() * 1000.0 << " ms ("
+              << (wall.count() > 0.0 ? simSeconds / wall.count() : 0.0) << "x real time)" << std::endl;
+
+    if (session.isRecording())
+    {
+        session.getJournal().save(options.recordPath);
+    }
+
+    return results.size() == static_cast<size_t>(options.rides) ? 0 : 1;
+}
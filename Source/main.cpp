@@ -18,12 +18,23 @@
 #include "../Header/util.hpp"
 #include "../Header/wagon.hpp"
 #include "../Header/trackpath.hpp"
+#include "../Header/trackindex.hpp"
+#include "../Header/trackmesh.hpp"
+#include "../Header/dynamics.hpp"
 #include "../Header/passenger.hpp"
+#include "../Header/resources.hpp"
+#include "../Header/session.hpp"
+#include "../Header/telemetry.hpp"
+#include "../Header/taskgraph.hpp"
+#include "../Header/threadpool.hpp"
 #include "../Header/Game/RollerCoaster.hpp"
 #include "../Header/Game/Constants.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
 #include <vector>
-#include <map>
 
 const int FPS = 75;
 
@@ -55,19 +66,33 @@ float fpPitch = 0.0f;
 double lastMouseX = 0, lastMouseY = 0;
 bool firstMouse = true;
 
+// Track picking (right click in orbit mode), resolved in the render loop where the view is known
+bool pickRequested = false;
+double pickX = 0, pickY = 0;
+
+// Track mesh pointer for the LOD stats key
+TrackMesh* g_trackMesh = nullptr;
+
 // Wagon pointer for keyboard callback access
 Wagon* g_wagon = nullptr;
 
 // Game logic
 RollerCoaster* g_game = nullptr;
 
-// Passenger models (pre-loaded, keyed by seat index)
-std::map<int, Passenger*> passengerModels;
+// Inputs that change the simulation go through the session, which applies them on tick boundaries
+// and records or replays them
+Session* g_session = nullptr;
+
+// Passenger models (pre-loaded, indexed by seat)
+std::vector<Passenger*> passengerModels;
+
+// Keys 1-8 reach the first eight seats, so the game seats that many riders in the lead car
+const int KEY_SEATS = 8;
 
 void mouseCallback(GLFWwindow* window, double xpos, double ypos)
 {
-    // Only rotate camera when left mouse button is pressed
-    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) != GLFW_PRESS)
+    // Only rotate camera when left mouse button is pressed, and leave it to the journal during a replay
+    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) != GLFW_PRESS || (g_session && g_session->isReplaying()))
     {
         lastMouseX = xpos;
         lastMouseY = ypos;
@@ -99,6 +124,15 @@ void mouseCallback(GLFWwindow* window, double xpos, double ypos)
     }
 }
 
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+{
+    if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS && cameraMode == CameraMode::ORBIT)
+    {
+        glfwGetCursorPos(window, &pickX, &pickY);
+        pickRequested = true;
+    }
+}
+
 void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
     if (action != GLFW_PRESS) return;
@@ -111,14 +145,14 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
 
     // Game controls
     case GLFW_KEY_SPACE:
-        if (g_game) {
-            g_game->handleAddPassenger();
+        if (g_session) {
+            g_session->submit(SessionCommand::ADD_PASSENGER);
         }
         break;
 
     case GLFW_KEY_ENTER:
-        if (g_game) {
-            g_game->handleStartRide();
+        if (g_session) {
+            g_session->submit(SessionCommand::START_RIDE);
         }
         break;
 
@@ -131,9 +165,9 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     case GLFW_KEY_6:
     case GLFW_KEY_7:
     case GLFW_KEY_8:
-        if (g_game) {
+        if (g_session) {
             int seatIndex = key - GLFW_KEY_1;  // Convert key to 0-7 index
-            g_game->handleSeatAction(seatIndex);
+            g_session->submit(SessionCommand::SEAT_ACTION, static_cast<uint16_t>(seatIndex));
         }
         break;
 
@@ -168,10 +202,33 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
         std::cout << (isCCWWinding ? "CCW WINDING" : "CW WINDING") << std::endl;
         break;
 
+    case GLFW_KEY_F5:
+        if (g_trackMesh) {
+            const TrackMesh::DrawStats& stats = g_trackMesh->getLastDrawStats();
+            std::cout << "TRACK LOD: " << stats.trianglesSubmitted << " triangles in " << stats.drawCalls
+                      << " draw calls (" << stats.trianglesFullDetail << " at full detail), chunks per level:";
+            for (int lod = 0; lod < TrackMesh::MAX_LODS; ++lod) {
+                if (stats.chunksPerLod[lod] > 0) {
+                    std::cout << " L" << lod << "=" << stats.chunksPerLod[lod];
+                }
+            }
+            std::cout << std::endl;
+        }
+        break;
+
+    case GLFW_KEY_F6:
+        if (g_session) {
+            g_session->submit(SessionCommand::TOGGLE_DYNAMICS);
+        }
+        break;
+
     case GLFW_KEY_V:
+        if (g_session && g_session->isReplaying()) {
+            break;
+        }
         if (cameraMode == CameraMode::ORBIT) {
             // Only allow FPV if there are passengers
-            if (g_game && !g_game->getPassengers().empty()) {
+            if (g_game && g_game->getPassengerCount() > 0) {
                 cameraMode = CameraMode::FIRST_PERSON;
                 fpYaw = 0.0f;
                 fpPitch = 0.0f;
@@ -187,8 +244,21 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
     }
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // --record FILE saves a journal of the session on exit, --replay FILE plays one back,
+    // --telemetry FILE streams per-seat G-forces and jerk to a file
+    std::string recordPath, replayPath, telemetryPath;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--record") == 0) {
+            recordPath = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--replay") == 0) {
+            replayPath = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--telemetry") == 0) {
+            telemetryPath = argv[i + 1];
+        }
+    }
+
     if (!glfwInit())
     {
         std::cout << "GLFW fail!\n" << std::endl;
@@ -222,56 +292,197 @@ int main()
     // Set callbacks
     glfwSetKeyCallback(window, keyCallback);
     glfwSetCursorPosCallback(window, mouseCallback);
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
 
-    // Load models and shaders
-    Model track("res/track.obj");
-    Shader sceneShader("Shader/basic.vert", "Shader/basic.frag");
-    Shader overlayShader("Shader/texture.vert", "Shader/texture.frag");
+    double startupBegin = glfwGetTime();
 
-    // Extract track center line for wagon positioning
+    // Everything startup creates, filled in by the startup tasks below
+    std::unique_ptr<Shader> sceneShaderPtr, overlayShaderPtr;
     TrackPath trackPath;
-    trackPath.extractFromModel(track, 300, 384);
+    uint64_t trackPathKey = 0;
+    bool trackPathCached = false;
+    double trackPathTime = 0.0;
+    TrackMesh trackMesh;
+    TrackSpatialIndex trackIndex;
 
-    // Create wagon and place it at the beginning of the track
+    // Create wagon; it is placed at the beginning of the track with the game
     Wagon wagon(8.0f, 5.0f, 14.0f);
-    wagon.init();
     wagon.setHeightOffset(3.5f);  // Height above track center line
-    g_wagon = &wagon;  // Set global pointer for keyboard callback
+    wagon.setCarCount(3);         // Riders board the lead car first
+
+    // A passenger for every seat (displayed dynamically based on game state)
+    // There are PERSON_MODELS different people, who take turns in the seats and share one model each
+    const int PERSON_MODELS = 8;
+    RideConfig rideConfig;
+    rideConfig.seats = KEY_SEATS;
+    passengerModels.resize(RollerCoaster::seatCapacity(rideConfig, wagon.getCarCount()));
+
+    // Models, textures and shared geometry, each loaded once however many objects use it
+    ResourceManager resources;
+    std::vector<ModelHandle> personModels(std::min<size_t>(PERSON_MODELS, passengerModels.size()));
+    TextureHandle studentTexture, grassTexture;
+    unsigned int greenTexture = 0;
+    unsigned int overlayVAO, overlayVBO;
+    unsigned int greenOverlayVAO, greenOverlayVBO;
+    unsigned int groundVAO, groundVBO;
+    int groundVertexCount;
 
-    // Create game logic (will set wagon position to START_TRACK_T)
-    RollerCoaster game(wagon, trackPath);
-    g_game = &game;
+    {
+        // Startup is a task graph: reading, decoding and path extraction run on the pool, anything that
+        // creates GL objects runs here on the main thread as soon as its inputs are ready
+        WorkStealingPool startupPool;
+        TaskGraph startup(startupPool);
+
+        // Load shaders
+        startup.addMain("scene shader", [&]() {
+            sceneShaderPtr.reset(new Shader("Shader/basic.vert", "Shader/basic.frag"));
+        });
+        startup.addMain("overlay shader", [&]() {
+            overlayShaderPtr.reset(new Shader("Shader/texture.vert", "Shader/texture.frag"));
+        });
+
+        // Extract track center line for wagon positioning (cached between runs)
+        // The imported track model is only needed when the cache is stale, and only on the CPU side
+        TaskGraph::TaskId trackPathTask = startup.addWorker("track path", [&]() {
+            double begin = glfwGetTime();
+            trackPathCached = trackPath.loadFromCache("res/track.pathcache", "res/track.obj", trackPathKey, 300, 384);
+            if (!trackPathCached) {
+                trackPathKey = TrackPath::computeCacheKey("res/track.obj", 300, 384);
+                Model trackModel;
+                trackModel.load("res/track.obj", true);
+                trackPath.extractFromModel(trackModel, 300, 384);
+                trackPath.saveToCache("res/track.pathcache", "res/track.obj", trackPathKey, 300, 384);
+            }
+            trackPathTime = glfwGetTime() - begin;
+        });
+
+        // Track geometry is swept along the path, with more rings in curves than on straights
+        TaskGraph::TaskId trackMeshTask = startup.addWorker("track mesh", [&]() {
+            trackMesh.prepare(trackPath);
+        }, { trackPathTask });
+        startup.addMain("track mesh upload", [&]() {
+            trackMesh.upload();
+        }, { trackMeshTask });
+
+        // Spatial index for turning screen/world positions back into track positions
+        startup.addWorker("track index", [&]() {
+            trackIndex.build(trackPath);
+        }, { trackPathTask });
+
+        // Textures decode on the workers into the resource manager; whoever takes them first uploads them
+        TaskGraph::TaskId wagonDecode = startup.addWorker("wagon texture", [&]() {
+            resources.loadTexture("res/textures/wagon_texture.jpg");
+        });
+        TaskGraph::TaskId seatDecode = startup.addWorker("seat texture", [&]() {
+            resources.loadTexture("res/textures/seat_texture.jpg");
+        });
+        startup.addMain("wagon upload", [&]() {
+            wagon.init(resources);
+        }, { wagonDecode, seatDecode });
+
+        // Student info texture
+        TaskGraph::TaskId studentDecode = startup.addWorker("student texture", [&]() {
+            studentTexture = resources.loadTexture("res/student.png");
+        });
+        startup.addMain("student upload", [&]() {
+            if (studentTexture) {
+                studentTexture->upload();
+            }
+        }, { studentDecode });
+
+        // Passengers: every person's model loads once on a worker, then the passengers in that person's
+        // seats share it along with the seatbelt
+        TaskGraph::TaskId seatbeltDecode = startup.addWorker("seatbelt texture", [&]() {
+            resources.loadTexture("res/textures/seatbelt_texture.jpg");
+        });
+        std::vector<TaskGraph::TaskId> personUploads;
+        for (size_t p = 0; p < personModels.size(); ++p) {
+            std::string path = "res/person" + std::to_string(p + 1) + "/model_mesh.obj";
+            TaskGraph::TaskId personLoad = startup.addWorker("person " + std::to_string(p + 1), [&, path, p]() {
+                personModels[p] = resources.loadModel(path);
+            });
+            personUploads.push_back(startup.addMain("person " + std::to_string(p + 1) + " upload", [&, p]() {
+                if (personModels[p]) {
+                    personModels[p]->upload();
+                }
+            }, { personLoad }));
+        }
+        for (int i = 0; i < static_cast<int>(passengerModels.size()); ++i) {
+            size_t person = i % personModels.size();
+            startup.addMain("passenger " + std::to_string(i), [&, i, person]() {
+                // A seat whose person failed to load stays empty on screen
+                if (!personModels[person]) {
+                    return;
+                }
+                passengerModels[i] = new Passenger(personModels[person], i);
+                passengerModels[i]->init(resources);
+            }, { personUploads[person], seatbeltDecode });
+        }
 
-    // Load student info texture
-    unsigned int studentTexture = loadTexture("res/student.png");
+        // Setup overlay quad
+        startup.addMain("overlays", [&]() {
+            setupOverlayQuad(overlayVAO, overlayVBO);
+
+            // Setup green overlay for sick camera passenger
+            setupFullscreenQuad(greenOverlayVAO, greenOverlayVBO);
+            greenTexture = createGreenTexture();
+        });
+
+        // Setup ground
+        TaskGraph::TaskId grassDecode = startup.addWorker("grass texture", [&]() {
+            // Repeat for tiling
+            TextureSettings tiled;
+            tiled.repeat = true;
+            grassTexture = resources.loadTexture("res/textures/grass_texture.jpg", tiled);
+        });
+        startup.addMain("ground upload", [&]() {
+            setupGroundMesh(groundVAO, groundVBO, groundVertexCount, 500.0f, 500.0f, 2.0f, 40.0f);
+            if (grassTexture) {
+                grassTexture->upload();
+            }
+        }, { grassDecode });
 
-    // Pre-load all 8 passenger models (will be displayed dynamically based on game state)
-    std::cout << "Loading passenger models..." << std::endl;
-    for (int i = 0; i < static_cast<int>(MAX_PASSENGERS); ++i) {
-        std::string path = "res/person" + std::to_string(i + 1) + "/model_mesh.obj";
-        passengerModels[i] = new Passenger(path, i);
+        startup.run();
+
+        std::cout << "Track path ready in " << trackPathTime * 1000.0 << " ms ("
+                  << (trackPathCached ? "warm, from cache" : "cold, extracted") << ")" << std::endl;
+        std::cout << "Startup: " << startup.getTaskCount() << " tasks in " << startup.getElapsed() << " ms on "
+                  << startupPool.size() << " workers and the main thread (" << startup.getWorkerTime()
+                  << " ms of worker tasks, " << startup.getMainTime() << " ms of main thread tasks)" << std::endl;
+        startup.printTimeline();
     }
-    std::cout << "Passenger models loaded." << std::endl;
+    resources.printReport();
 
-    // Setup overlay quad
-    unsigned int overlayVAO, overlayVBO;
-    setupOverlayQuad(overlayVAO, overlayVBO);
+    Shader& sceneShader = *sceneShaderPtr;
+    Shader& overlayShader = *overlayShaderPtr;
+    g_trackMesh = &trackMesh;
+    g_wagon = &wagon;  // Set global pointer for keyboard callback
 
-    // Setup green overlay for sick camera passenger
-    unsigned int greenOverlayVAO, greenOverlayVBO;
-    setupFullscreenQuad(greenOverlayVAO, greenOverlayVBO);
-    unsigned int greenTexture = createGreenTexture();
+    // Physical model in metres and seconds, switched on with F6
+    TrainDynamics dynamics;
+    dynamics.getParams().carCount = wagon.getCarCount();
+    dynamics.getParams().carSpacing = wagon.getCarSpacing() * dynamics.getParams().metresPerUnit;
+    dynamics.setRideZones(trackPath, rideConfig.endTrackT, wagon.getArcadeParams().cruiseSpeed, rideConfig.reverseVelocity);
 
-    // Setup ground
-    unsigned int groundVAO, groundVBO;
-    int groundVertexCount;
-    setupGroundMesh(groundVAO, groundVBO, groundVertexCount, 500.0f, 500.0f, 2.0f, 40.0f);
-    unsigned int grassTexture = loadTexture("res/textures/grass_texture.jpg");
-    // Override wrap mode to repeat for tiling
-    glBindTexture(GL_TEXTURE_2D, grassTexture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Create game logic (will set wagon position to START_TRACK_T)
+    RollerCoaster game(wagon, trackPath, rideConfig);
+    g_game = &game;
+
+    Session session(game, wagon, trackPath, &dynamics);
+    g_session = &session;
+    if (!replayPath.empty()) {
+        SessionJournal journal;
+        if (!journal.load(replayPath) || !session.startReplay(journal, trackPathKey)) {
+            std::cout << "Replay unavailable, running live" << std::endl;
+        }
+    } else if (!recordPath.empty()) {
+        session.startRecording(trackPathKey);
+    }
+
+    Telemetry telemetry;
+    if (!telemetryPath.empty() && telemetry.start(telemetryPath, 1.0f / SIM_TIMESTEP)) {
+        session.setTelemetry(&telemetry);
+    }
 
     // Setup 3D scene
     sceneShader.use();
@@ -286,6 +497,9 @@ int main()
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 500.0f);
     sceneShader.setMat4("uP", projection);
 
+    // Pixels per world unit at distance 1, for choosing track detail levels
+    float pixelScale = mode->height / (2.0f * tan(glm::radians(45.0f) * 0.5f));
+
     // View matrix will be calculated each frame based on mouse input
 
     glm::mat4 model = glm::mat4(1.0f);
@@ -313,6 +527,7 @@ int main()
 
     std::cout << "Controls:" << std::endl;
     std::cout << "  Mouse  - Orbit camera around track" << std::endl;
+    std::cout << "  RMB    - Pick a point on the track (orbit camera)" << std::endl;
     std::cout << "  SPACE  - Add passenger" << std::endl;
     std::cout << "  1-8    - Seatbelt (onboarding) / Sick (riding) / Remove (offboarding)" << std::endl;
     std::cout << "  ENTER  - Start ride (all passengers must be buckled)" << std::endl;
@@ -322,27 +537,72 @@ int main()
     std::cout << "  F2     - Toggle face culling" << std::endl;
     std::cout << "  F3     - Toggle back/front face culling" << std::endl;
     std::cout << "  F4     - Toggle winding order (CCW/CW)" << std::endl;
+    std::cout << "  F5     - Print track triangles submitted last frame" << std::endl;
+    std::cout << "  F6     - Toggle wagon dynamics (arcade / physical)" << std::endl;
+
+    std::cout << "Startup took " << (glfwGetTime() - startupBegin) * 1000.0 << " ms" << std::endl;
 
     double lastTimeForRefresh = glfwGetTime();
     double lastTime = glfwGetTime();
+    float simAccumulator = 0.0f;
     size_t prevPassengerCount = 0;
 
+    // Camera as last written to the journal
+    CameraMode recordedCameraMode = cameraMode;
+    float recordedYaw = cameraYaw, recordedPitch = cameraPitch;
+
+    // Frame timing of a replay, so the same session can be compared before and after a change
+    bool timingReplay = session.isReplaying();
+    double replayWorkTime = 0.0;
+    long long replayFrames = 0;
+
     // Render loop
     while (!glfwWindowShouldClose(window))
     {
         // Calculate delta time
         double currentTime = glfwGetTime();
-        float deltaTime = static_cast<float>(currentTime - lastTime);
+        float frameTime = static_cast<float>(currentTime - lastTime);
         lastTime = currentTime;
+        if (frameTime > MAX_FRAME_TIME) {
+            frameTime = MAX_FRAME_TIME;
+        }
 
         glfwPollEvents();
 
-        // Update game logic (handles wagon physics internally)
-        game.update(deltaTime);
-        wagon.updatePhysics(trackPath, deltaTime);
+        if (session.isRecording()) {
+            float yaw = cameraMode == CameraMode::ORBIT ? cameraYaw : fpYaw;
+            float pitch = cameraMode == CameraMode::ORBIT ? cameraPitch : fpPitch;
+            if (cameraMode != recordedCameraMode || yaw != recordedYaw || pitch != recordedPitch) {
+                session.submit(SessionCommand::VIEW, static_cast<uint8_t>(cameraMode), yaw, pitch);
+                recordedCameraMode = cameraMode;
+                recordedYaw = yaw;
+                recordedPitch = pitch;
+            }
+        }
+
+        // Run the game logic and wagon physics in fixed steps, whatever the frame rate
+        simAccumulator += frameTime;
+        while (simAccumulator >= SIM_TIMESTEP) {
+            session.tick();
+            simAccumulator -= SIM_TIMESTEP;
+
+            for (const JournalEntry& entry : session.getViewCommands()) {
+                cameraMode = static_cast<CameraMode>(entry.arg);
+                if (cameraMode == CameraMode::ORBIT) {
+                    cameraYaw = entry.value[0];
+                    cameraPitch = entry.value[1];
+                } else {
+                    fpYaw = entry.value[0];
+                    fpPitch = entry.value[1];
+                }
+            }
+        }
+
+        // Draw the wagon (and the passengers riding it) between the last two steps
+        wagon.interpolate(trackPath, simAccumulator / SIM_TIMESTEP);
 
         // Auto-switch camera on passenger count changes
-        size_t currentPassengerCount = game.getPassengers().size();
+        size_t currentPassengerCount = game.getPassengerCount();
         if (prevPassengerCount == 0 && currentPassengerCount > 0) {
             // First passenger added → switch to FPV
             cameraMode = CameraMode::FIRST_PERSON;
@@ -373,7 +633,7 @@ int main()
             cameraPos = seat.position + seat.up * 6.0f + seat.forward * 0.5f; // Eye height above seat + in front of person model
 
             // Calculate look direction with mouse offset
-            glm::vec3 right = glm::normalize(glm::cross(seat.forward, seat.up));
+            const glm::vec3& right = seat.right;
 
             // Apply yaw rotation (around up axis)
             glm::mat4 yawRot = glm::rotate(glm::mat4(1.0f), glm::radians(fpYaw), seat.up);
@@ -386,6 +646,30 @@ int main()
             view = glm::lookAt(cameraPos, cameraPos + lookDir, seat.up);
         }
 
+        // Resolve a track pick with this frame's camera
+        if (pickRequested) {
+            pickRequested = false;
+
+            int windowWidth, windowHeight;
+            glfwGetWindowSize(window, &windowWidth, &windowHeight);
+            float ndcX = static_cast<float>(2.0 * pickX / windowWidth - 1.0);
+            float ndcY = static_cast<float>(1.0 - 2.0 * pickY / windowHeight);
+
+            glm::mat4 invViewProj = glm::inverse(projection * view);
+            glm::vec4 nearPoint = invViewProj * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+            glm::vec4 farPoint = invViewProj * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+            glm::vec3 rayOrigin = glm::vec3(nearPoint) / nearPoint.w;
+            glm::vec3 rayDir = glm::vec3(farPoint) / farPoint.w - rayOrigin;
+
+            TrackHit hit;
+            if (trackIndex.raycast(rayOrigin, rayDir, 2.0f, hit)) {
+                std::cout << "TRACK: Picked " << hit.distance << " / " << trackPath.getLength()
+                          << " units along the track (t = " << hit.t << ")" << std::endl;
+            } else {
+                std::cout << "TRACK: Nothing picked" << std::endl;
+            }
+        }
+
         // Render 3D scene
         sceneShader.use();
         sceneShader.setMat4("uV", view);
@@ -396,10 +680,10 @@ int main()
         // Draw ground
         glm::mat4 groundModel = glm::translate(glm::mat4(1.0f), glm::vec3(30.0f, -5.0f, 10.0f));
         sceneShader.setMat4("uM", groundModel);
-        sceneShader.setBool("uUseTexture", true);
+        sceneShader.setBool("uUseTexture", grassTexture != nullptr);
         sceneShader.setVec3("uTintColor", 1.0f, 1.0f, 1.0f);
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, grassTexture);
+        glBindTexture(GL_TEXTURE_2D, grassTexture ? grassTexture->id : 0);
         glBindVertexArray(groundVAO);
         glDrawArrays(GL_TRIANGLES, 0, groundVertexCount);
         glBindVertexArray(0);
@@ -408,15 +692,18 @@ int main()
         sceneShader.setMat4("uM", model);
         sceneShader.setBool("uUseTexture", false);
         sceneShader.setVec3("uMaterialColor", 0.6f, 0.3f, 0.1f);  // Brown track color
-        track.Draw(sceneShader);
+        trackMesh.draw(cameraPos, pixelScale);
 
         // Draw wagon
         wagon.draw(sceneShader);
 
         // Draw passengers based on game state
-        for (const Person& person : game.getPassengers()) {
-            int seatIndex = person.getSeatIndex();
+        for (int seatIndex = game.nextPassengerSeat(0); seatIndex >= 0; seatIndex = game.nextPassengerSeat(seatIndex + 1)) {
+            const Person& person = *game.getPassengerBySeat(seatIndex);
             Passenger* passengerModel = passengerModels[seatIndex];
+            if (!passengerModel) {
+                continue;
+            }
 
             // Sync rendering state with game logic
             passengerModel->setBuckled(person.getHasSeatbelt());
@@ -439,41 +726,69 @@ int main()
         }
 
         // Render 2D overlay (student info)
-        glDepthFunc(GL_ALWAYS); // Always pass depth test for overlay
-        glDisable(GL_CULL_FACE); // Disable culling for overlay
-        overlayShader.use();
-        glBindTexture(GL_TEXTURE_2D, studentTexture);
-        glBindVertexArray(overlayVAO);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glDepthFunc(GL_LESS); // Reset depth function
-        // Reset culling settings
-        if (faceCullingEnabled)
-            glEnable(GL_CULL_FACE);
-        else
-            glDisable(GL_CULL_FACE);
+        if (studentTexture) {
+            glDepthFunc(GL_ALWAYS); // Always pass depth test for overlay
+            glDisable(GL_CULL_FACE); // Disable culling for overlay
+            overlayShader.use();
+            glBindTexture(GL_TEXTURE_2D, studentTexture->id);
+            glBindVertexArray(overlayVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            glDepthFunc(GL_LESS); // Reset depth function
+            // Reset culling settings
+            if (faceCullingEnabled)
+                glEnable(GL_CULL_FACE);
+            else
+                glDisable(GL_CULL_FACE);
+        }
+
+        // Work per frame, without the swap and the frame limiter
+        if (timingReplay) {
+            ++replayFrames;
+            replayWorkTime += glfwGetTime() - currentTime;
+            if (!session.isReplaying()) {
+                std::cout << "Replay: " << replayFrames << " frames, " << replayWorkTime * 1000.0 / replayFrames
+                          << " ms of work per frame" << std::endl;
+                timingReplay = false;
+            }
+        }
 
         glfwSwapBuffers(window);
         limitFPS(lastTimeForRefresh, FPS);
     }
 
+    if (session.isRecording()) {
+        session.getJournal().save(recordPath);
+    }
+    telemetry.stop();
+
     // Cleanup
+    g_session = nullptr;
     g_wagon = nullptr;
     g_game = nullptr;
 
     // Cleanup passenger models
-    for (auto& pair : passengerModels) {
-        delete pair.second;
+    for (Passenger* passengerModel : passengerModels) {
+        delete passengerModel;
     }
     passengerModels.clear();
 
+    // Shared models and textures go while the GL context is still there; the wagon is only
+    // destroyed after glfwTerminate(), so it lets go of its texture handles here
+    personModels.clear();
+    studentTexture.reset();
+    grassTexture.reset();
+    wagon.releaseTextures();
+    resources.releaseUnused();
+
+    // The track mesh is a local of this function too, so its buffers go before glfwTerminate()
+    trackMesh.release();
+
     glDeleteVertexArrays(1, &overlayVAO);
     glDeleteBuffers(1, &overlayVBO);
     glDeleteVertexArrays(1, &greenOverlayVAO);
     glDeleteBuffers(1, &greenOverlayVBO);
     glDeleteVertexArrays(1, &groundVAO);
     glDeleteBuffers(1, &groundVBO);
-    glDeleteTextures(1, &grassTexture);
-    glDeleteTextures(1, &studentTexture);
     glDeleteTextures(1, &greenTexture);
 
     glfwTerminate();
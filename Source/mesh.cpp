@@ -1,15 +1,41 @@
 #include "../Header/mesh.hpp"
 
+#include <utility>
+
 using namespace std;
 
 Mesh::Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+    : VAO(0), VBO(0), EBO(0), externalVertices(nullptr), externalIndices(nullptr)
 {
-    this->vertices = vertices;
-    this->indices = indices;
-    this->textures = textures;
+    this->vertices = std::move(vertices);
+    this->indices = std::move(indices);
+    this->textures = std::move(textures);
+    vertexCount = this->vertices.size();
+    indexCount = static_cast<unsigned int>(this->indices.size());
+}
+
+Mesh::Mesh(const Vertex* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount, vector<Texture> textures)
+    : VAO(0), VBO(0), EBO(0), externalVertices(vertices), externalIndices(indices), vertexCount(vertexCount)
+{
+    this->indexCount = static_cast<unsigned int>(indexCount);
+    this->textures = std::move(textures);
+}
 
+void Mesh::upload(bool keepGeometry)
+{
     // now that we have all the required data, set the vertex buffers and its attribute pointers.
-    setupMesh();
+    if (externalVertices)
+        setupMesh(externalVertices, externalIndices);
+    else
+        setupMesh(vertices.data(), indices.data());
+
+    externalVertices = nullptr;
+    externalIndices = nullptr;
+    if (!keepGeometry)
+    {
+        vector<Vertex>().swap(vertices);
+        vector<unsigned int>().swap(indices);
+    }
 }
 
 void Mesh::Draw(Shader& shader)
@@ -37,14 +63,14 @@ void Mesh::Draw(Shader& shader)
 
     // draw mesh
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 
     // always good practice to set everything back to defaults once configured.
     glActiveTexture(GL_TEXTURE0);
 }
 
-void Mesh::setupMesh()
+void Mesh::setupMesh(const Vertex* vertexData, const unsigned int* indexData)
 {
     // create buffers/arrays
     glGenVertexArrays(1, &VAO);
@@ -57,10 +83,10 @@ void Mesh::setupMesh()
     // A great thing about structs is that their memory layout is sequential for all its items.
     // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
     // again translates to 3/2 floats which translates to a byte array.
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertexData, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
 
     // set the vertex attribute pointers
     // vertex Positions
@@ -0,0 +1,287 @@
+#include "../Header/meshcache.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+// Cooked model layout: FileHeader, then
+//   meshes      numMeshes   * MeshRecord
+//   textures    numTextures * TextureRecord
+//   strings     stringBytes (texture types and paths, not terminated)
+//   padding to 16 bytes, then per mesh its vertices (vertexCount * VERTEX_SIZE) and
+//   indices (indexCount * uint32), each block starting on a 16-byte boundary
+
+namespace
+{
+
+const char COOKED_MAGIC[4] = { 'R', 'C', 'M', 'S' };
+const uint32_t COOKED_VERSION = 1;
+const size_t DATA_ALIGNMENT = 16;
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceSize;
+    int64_t sourceTime;     // Modification time of the source, seconds since the epoch
+    uint32_t vertexSize;
+    uint32_t numMeshes;
+    uint32_t numTextures;
+    uint32_t stringBytes;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct MeshRecord
+{
+    uint64_t vertexOffset;  // From the start of the file
+    uint64_t indexOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t firstTexture;
+    uint32_t numTextures;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct TextureRecord
+{
+    uint32_t typeOffset;    // Into the string block
+    uint32_t typeLength;
+    uint32_t pathOffset;
+    uint32_t pathLength;
+};
+
+size_t alignUp(size_t offset)
+{
+    return (offset + DATA_ALIGNMENT - 1) & ~(DATA_ALIGNMENT - 1);
+}
+
+} // namespace
+
+std::string CookedModel::cachePathFor(const std::string& sourcePath)
+{
+    size_t dot = sourcePath.find_last_of('.');
+    size_t slash = sourcePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+        return sourcePath + ".rcmesh";
+    }
+    return sourcePath.substr(0, dot) + ".rcmesh";
+}
+
+bool CookedModel::write(const std::string& cachePath, const std::string& sourcePath, const std::vector<MeshSource>& sources)
+{
+    FileHeader header;
+    std::memcpy(header.magic, COOKED_MAGIC, sizeof(COOKED_MAGIC));
+    header.version = COOKED_VERSION;
+    if (!fileStamp(sourcePath, header.sourceSize, header.sourceTime))
+    {
+        return false;
+    }
+    header.vertexSize = static_cast<uint32_t>(VERTEX_SIZE);
+    header.numMeshes = static_cast<uint32_t>(sources.size());
+
+    // Tables first, so the data offsets are known before anything is written
+    std::vector<MeshRecord> records(sources.size());
+    std::vector<TextureRecord> textures;
+    std::string strings;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        header.boundsMin[axis] = FLT_MAX;
+        header.boundsMax[axis] = -FLT_MAX;
+    }
+
+    for (size_t m = 0; m < sources.size(); ++m)
+    {
+        const MeshSource& source = sources[m];
+        MeshRecord& record = records[m];
+        record.vertexCount = source.vertexCount;
+        record.indexCount = source.indexCount;
+        record.firstTexture = static_cast<uint32_t>(textures.size());
+        record.numTextures = static_cast<uint32_t>(source.textures.size());
+
+        for (const TextureRef& texture : source.textures)
+        {
+            TextureRecord out;
+            out.typeOffset = static_cast<uint32_t>(strings.size());
+            out.typeLength = static_cast<uint32_t>(texture.type.size());
+            strings += texture.type;
+            out.pathOffset = static_cast<uint32_t>(strings.size());
+            out.pathLength = static_cast<uint32_t>(texture.path.size());
+            strings += texture.path;
+            textures.push_back(out);
+        }
+
+        // Positions are the first three floats of every vertex
+        const unsigned char* vertex = static_cast<const unsigned char*>(source.vertices);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            record.boundsMin[axis] = FLT_MAX;
+            record.boundsMax[axis] = -FLT_MAX;
+        }
+        for (uint32_t v = 0; v < source.vertexCount; ++v, vertex += VERTEX_SIZE)
+        {
+            float position[3];
+            std::memcpy(position, vertex, sizeof(position));
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                record.boundsMin[axis] = std::min(record.boundsMin[axis], position[axis]);
+                record.boundsMax[axis] = std::max(record.boundsMax[axis], position[axis]);
+            }
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            header.boundsMin[axis] = std::min(header.boundsMin[axis], record.boundsMin[axis]);
+            header.boundsMax[axis] = std::max(header.boundsMax[axis], record.boundsMax[axis]);
+        }
+    }
+    header.numTextures = static_cast<uint32_t>(textures.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+
+    size_t offset = alignUp(sizeof(FileHeader) + records.size() * sizeof(MeshRecord) +
+                            textures.size() * sizeof(TextureRecord) + strings.size());
+    for (MeshRecord& record : records)
+    {
+        record.vertexOffset = offset;
+        offset = alignUp(offset + static_cast<size_t>(record.vertexCount) * VERTEX_SIZE);
+        record.indexOffset = offset;
+        offset = alignUp(offset + static_cast<size_t>(record.indexCount) * sizeof(uint32_t));
+    }
+
+    // Write to a temporary file and rename, so neither a crash nor a model loading on another thread
+    // ever sees a half-written file; the name is per thread, as two threads may cook the same model
+    std::string tempPath = cachePath + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "CookedModel: Cannot write " << tempPath << std::endl;
+        return false;
+    }
+
+    const char zeros[DATA_ALIGNMENT] = {};
+    auto padTo = [&](size_t position) {
+        size_t current = static_cast<size_t>(out.tellp());
+        out.write(zeros, position - current);
+    };
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(MeshRecord));
+    out.write(reinterpret_cast<const char*>(textures.data()), textures.size() * sizeof(TextureRecord));
+    out.write(strings.data(), strings.size());
+    for (size_t m = 0; m < sources.size(); ++m)
+    {
+        padTo(static_cast<size_t>(records[m].vertexOffset));
+        out.write(static_cast<const char*>(sources[m].vertices), static_cast<size_t>(sources[m].vertexCount) * VERTEX_SIZE);
+        padTo(static_cast<size_t>(records[m].indexOffset));
+        out.write(reinterpret_cast<const char*>(sources[m].indices), static_cast<size_t>(sources[m].indexCount) * sizeof(uint32_t));
+    }
+    padTo(offset);
+
+    out.close();
+    if (!out)
+    {
+        std::cerr << "CookedModel: Failed writing " << tempPath << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    std::remove(cachePath.c_str());
+    if (std::rename(tempPath.c_str(), cachePath.c_str()) != 0)
+    {
+        std::cerr << "CookedModel: Cannot replace " << cachePath << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CookedModel::open(const std::string& cachePath, const std::string& sourcePath)
+{
+    close();
+
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    if (!fileStamp(sourcePath, sourceSize, sourceTime) || !file.open(cachePath) || file.size() < sizeof(FileHeader))
+    {
+        close();
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, COOKED_MAGIC, sizeof(COOKED_MAGIC)) != 0 || header.version != COOKED_VERSION ||
+        header.vertexSize != VERTEX_SIZE || header.sourceSize != sourceSize || header.sourceTime != sourceTime)
+    {
+        close();
+        return false;
+    }
+
+    size_t tablesEnd = sizeof(FileHeader) + static_cast<size_t>(header.numMeshes) * sizeof(MeshRecord) +
+                       static_cast<size_t>(header.numTextures) * sizeof(TextureRecord) + header.stringBytes;
+    if (tablesEnd > file.size())
+    {
+        close();
+        return false;
+    }
+
+    const unsigned char* base = file.data();
+    const MeshRecord* records = reinterpret_cast<const MeshRecord*>(base + sizeof(FileHeader));
+    const TextureRecord* textures = reinterpret_cast<const TextureRecord*>(records + header.numMeshes);
+    const char* strings = reinterpret_cast<const char*>(textures + header.numTextures);
+
+    meshes.resize(header.numMeshes);
+    for (uint32_t m = 0; m < header.numMeshes; ++m)
+    {
+        MeshRecord record;
+        std::memcpy(&record, &records[m], sizeof(record));
+        uint64_t vertexEnd = record.vertexOffset + static_cast<uint64_t>(record.vertexCount) * VERTEX_SIZE;
+        uint64_t indexEnd = record.indexOffset + static_cast<uint64_t>(record.indexCount) * sizeof(uint32_t);
+        if (vertexEnd > file.size() || indexEnd > file.size() ||
+            static_cast<uint64_t>(record.firstTexture) + record.numTextures > header.numTextures)
+        {
+            close();
+            return false;
+        }
+
+        MeshView& view = meshes[m];
+        view.vertices = base + record.vertexOffset;
+        view.vertexCount = record.vertexCount;
+        view.indices = reinterpret_cast<const uint32_t*>(base + record.indexOffset);
+        view.indexCount = record.indexCount;
+        std::memcpy(view.boundsMin, record.boundsMin, sizeof(view.boundsMin));
+        std::memcpy(view.boundsMax, record.boundsMax, sizeof(view.boundsMax));
+
+        view.textures.clear();
+        for (uint32_t t = 0; t < record.numTextures; ++t)
+        {
+            TextureRecord texture;
+            std::memcpy(&texture, &textures[record.firstTexture + t], sizeof(texture));
+            if (static_cast<uint64_t>(texture.typeOffset) + texture.typeLength > header.stringBytes ||
+                static_cast<uint64_t>(texture.pathOffset) + texture.pathLength > header.stringBytes)
+            {
+                close();
+                return false;
+            }
+            TextureRef ref;
+            ref.type.assign(strings + texture.typeOffset, texture.typeLength);
+            ref.path.assign(strings + texture.pathOffset, texture.pathLength);
+            view.textures.push_back(ref);
+        }
+    }
+
+    std::memcpy(boundsMin, header.boundsMin, sizeof(boundsMin));
+    std::memcpy(boundsMax, header.boundsMax, sizeof(boundsMax));
+    return true;
+}
+
+void CookedModel::close()
+{
+    meshes.clear();
+    file.close();
+}
@@ -1,6 +1,6 @@
-#include "../stb_image.h"
-
 #include "../Header/model.hpp"
+#include "../Header/meshcache.hpp"
+#include "../Header/resources.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
@@ -9,19 +9,62 @@
 
 using namespace std;
 
-Model::Model(string const& path, bool gamma) : gammaCorrection(gamma)
+// cooked files store vertices exactly as the Vertex struct lays them out
+static_assert(sizeof(Vertex) == CookedModel::VERTEX_SIZE, "Vertex layout differs from the cooked model format");
+static_assert(sizeof(unsigned int) == sizeof(uint32_t), "Cooked indices are 32-bit");
+
+// model textures keep the file's channels and are not flipped - ASSIMP already flips UV coordinates via aiProcess_FlipUVs
+static TextureSettings modelTextureSettings()
+{
+    TextureSettings settings;
+    settings.flip = false;
+    settings.repeat = true;
+    settings.channels = 0;
+    return settings;
+}
+
+Model::Model() : gammaCorrection(false), cooked(false), uploaded(false), keepGeometry(false), resources(nullptr)
 {
-    loadModel(path);
 }
 
+Model::Model(string const& path, bool gamma, bool keepGeometry)
+    : gammaCorrection(gamma), cooked(false), uploaded(false), keepGeometry(false), resources(nullptr)
+{
+    load(path, keepGeometry);
+    upload();
+}
+
+// out of line, where CookedModel is complete
+Model::~Model() = default;
+
 void Model::Draw(Shader& shader)
 {
     for (unsigned int i = 0; i < meshes.size(); i++)
         meshes[i].Draw(shader);
 }
 
-void Model::loadModel(string const& path)
+bool Model::load(string const& path, bool keep, ResourceManager* manager)
 {
+    keepGeometry = keep;
+    resources = manager;
+
+    // retrieve the directory path of the filepath
+    directory = path.substr(0, path.find_last_of('/'));
+
+    // the cooked file maps straight into the GL buffers, skipping the import entirely
+    string cachePath = CookedModel::cachePathFor(path);
+    unique_ptr<CookedModel> cookedModel(new CookedModel());
+    if (cookedModel->open(cachePath, path))
+    {
+        loadCooked(*cookedModel);
+        cooked = true;
+        resources = nullptr;
+        // kept geometry was copied out, otherwise the meshes read from the mapping when they upload
+        if (!keepGeometry)
+            cookedFile = std::move(cookedModel);
+        return true;
+    }
+
     // read file via ASSIMP
     Assimp::Importer importer;
     const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
@@ -29,13 +72,115 @@ void Model::loadModel(string const& path)
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
     {
         cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
-        return;
+        resources = nullptr;
+        return false;
     }
-    // retrieve the directory path of the filepath
-    directory = path.substr(0, path.find_last_of('/'));
 
     // process ASSIMP's root node recursively
+    meshes.reserve(scene->mNumMeshes);
     processNode(scene->mRootNode, scene);
+    resources = nullptr;
+
+    // cook it for the next run
+    cook(path, cachePath);
+    return true;
+}
+
+void Model::upload()
+{
+    if (uploaded)
+        return;
+    uploaded = true;
+
+    // shared textures may have been uploaded by another model already
+    // (a texture the manager couldn't read has no resource and stays at id 0)
+    for (size_t i = 0; i < textureResources.size(); i++)
+    {
+        if (!textureResources[i])
+            continue;
+        textureResources[i]->upload();
+        textures_loaded[i].id = textureResources[i]->id;
+    }
+
+    for (Mesh& mesh : meshes)
+    {
+        // meshes took their texture before it had an id
+        for (Texture& texture : mesh.textures)
+        {
+            for (const Texture& loaded : textures_loaded)
+            {
+                if (loaded.path == texture.path)
+                {
+                    texture.id = loaded.id;
+                    break;
+                }
+            }
+        }
+        mesh.upload(keepGeometry);
+    }
+
+    // the buffers have their own copy now
+    cookedFile.reset();
+}
+
+size_t Model::getGpuBytes() const
+{
+    if (!uploaded)
+        return 0;
+    size_t bytes = 0;
+    for (const Mesh& mesh : meshes)
+        bytes += mesh.getVertexCount() * sizeof(Vertex) + mesh.indexCount * sizeof(unsigned int);
+    return bytes;
+}
+
+size_t Model::getCpuBytes() const
+{
+    size_t bytes = cookedFile ? cookedFile->getFileSize() : 0;
+    for (const Mesh& mesh : meshes)
+        bytes += mesh.vertices.capacity() * sizeof(Vertex) + mesh.indices.capacity() * sizeof(unsigned int);
+    return bytes;
+}
+
+void Model::loadCooked(const CookedModel& cookedModel)
+{
+    meshes.reserve(cookedModel.getMeshCount());
+    for (size_t i = 0; i < cookedModel.getMeshCount(); i++)
+    {
+        const CookedModel::MeshView& view = cookedModel.getMesh(i);
+        vector<Texture> textures;
+        for (const CookedModel::TextureRef& ref : view.textures)
+            textures.push_back(loadTexture(ref.path, ref.type));
+
+        const Vertex* vertices = static_cast<const Vertex*>(view.vertices);
+        const unsigned int* indices = reinterpret_cast<const unsigned int*>(view.indices);
+        if (keepGeometry)
+        {
+            meshes.push_back(Mesh(vector<Vertex>(vertices, vertices + view.vertexCount),
+                                  vector<unsigned int>(indices, indices + view.indexCount), std::move(textures)));
+        }
+        else
+        {
+            meshes.push_back(Mesh(vertices, view.vertexCount, indices, view.indexCount, std::move(textures)));
+        }
+    }
+}
+
+void Model::cook(string const& path, string const& cachePath) const
+{
+    vector<CookedModel::MeshSource> sources(meshes.size());
+    for (size_t i = 0; i < meshes.size(); i++)
+    {
+        const Mesh& mesh = meshes[i];
+        CookedModel::MeshSource& source = sources[i];
+        source.vertices = mesh.vertices.data();
+        source.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        source.indices = reinterpret_cast<const uint32_t*>(mesh.indices.data());
+        source.indexCount = static_cast<uint32_t>(mesh.indices.size());
+        for (const Texture& texture : mesh.textures)
+            source.textures.push_back({ texture.type, texture.path });
+    }
+    if (CookedModel::write(cachePath, path, sources))
+        cout << "Cooked " << path << " into " << cachePath << endl;
 }
 
 void Model::processNode(aiNode* node, const aiScene* scene)
@@ -61,6 +206,8 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
     vector<Vertex> vertices;
     vector<unsigned int> indices;
     vector<Texture> textures;
+    vertices.reserve(mesh->mNumVertices);
+    indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
 
     // walk through each of the mesh's vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++)
@@ -118,7 +265,7 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene)
     textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
 
     // return a mesh object created from the extracted mesh data
-    return Mesh(vertices, indices, textures);
+    return Mesh(std::move(vertices), std::move(indices), std::move(textures));
 }
 
 vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, string typeName)
@@ -128,69 +275,47 @@ vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type,
     {
         aiString str;
         mat->GetTexture(type, i, &str);
-        // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-        bool skip = false;
-        for (unsigned int j = 0; j < textures_loaded.size(); j++)
-        {
-            if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-            {
-                textures.push_back(textures_loaded[j]);
-                skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-                break;
-            }
-        }
-        if (!skip)
-        {   // if texture hasn't been loaded already, load it
-            Texture texture;
-            texture.id = TextureFromFile(str.C_Str(), this->directory);
-            texture.type = typeName;
-            texture.path = str.C_Str();
-            textures.push_back(texture);
-            textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecessary load duplicate textures.
-        }
+        textures.push_back(loadTexture(str.C_Str(), typeName));
     }
     return textures;
 }
 
-unsigned int TextureFromFile(const char* path, const string& directory, bool gamma)
+Texture Model::loadTexture(const string& path, const string& typeName)
 {
-    string filename = string(path);
-    filename = directory + '/' + filename;
+    // check if texture was loaded before and if so, reuse it instead of loading it again
+    unordered_map<string, size_t>::const_iterator found = textureIndex.find(path);
+    if (found != textureIndex.end())
+        return textures_loaded[found->second];
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+    // if texture hasn't been loaded already, decode it for upload()
+    Texture texture;
+    texture.id = 0;
+    texture.type = typeName;
+    texture.path = path;
+    textureIndex[path] = textures_loaded.size();
+    textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecessary load duplicate textures.
 
-    // Don't flip image - ASSIMP already flips UV coordinates via aiProcess_FlipUVs
-    stbi_set_flip_vertically_on_load(false);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
+    string filename = directory + '/' + path;
+    if (resources)
     {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
+        textureResources.push_back(resources->loadTexture(filename, modelTextureSettings()));
     }
     else
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        shared_ptr<TextureResource> resource(new TextureResource());
+        resource->decode(filename, modelTextureSettings());
+        textureResources.push_back(resource);
     }
+    return texture;
+}
 
-    return textureID;
+unsigned int TextureFromFile(const char* path, const string& directory, bool gamma)
+{
+    string filename = string(path);
+    filename = directory + '/' + filename;
+
+    // Don't flip image - ASSIMP already flips UV coordinates via aiProcess_FlipUVs
+    ImageData image;
+    decodeImage(filename.c_str(), image, 0, false);
+    return uploadTexture(image, filename.c_str(), true);
 }
@@ -0,0 +1,95 @@
+#include "../Header/objloader.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+bool loadObjTriangles(const std::string& path, std::vector<glm::vec3>& corners, float& meanEdgeLength)
+{
+    corners.clear();
+    meanEdgeLength = 0.0f;
+
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cerr << "ObjLoader: Cannot open " << path << std::endl;
+        return false;
+    }
+
+    std::vector<glm::vec3> positions;
+    std::vector<int> face;
+    std::string line;
+    double edgeSum = 0.0;
+
+    while (std::getline(file, line))
+    {
+        const char* p = line.c_str();
+        while (*p == ' ' || *p == '\t')
+        {
+            ++p;
+        }
+
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            char* end;
+            glm::vec3 v;
+            v.x = std::strtof(p + 2, &end);
+            v.y = std::strtof(end, &end);
+            v.z = std::strtof(end, &end);
+            positions.push_back(v);
+        }
+        else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+        {
+            // Corners are "v", "v/vt", "v//vn" or "v/vt/vn"; only the position index is used
+            face.clear();
+            p += 2;
+            while (*p)
+            {
+                char* end;
+                long index = std::strtol(p, &end, 10);
+                if (end == p)
+                {
+                    break;
+                }
+                // Negative indices count back from the last position read so far
+                long resolved = index > 0 ? index - 1 : static_cast<long>(positions.size()) + index;
+                if (resolved < 0 || resolved >= static_cast<long>(positions.size()))
+                {
+                    std::cerr << "ObjLoader: Face index out of range in " << path << std::endl;
+                    return false;
+                }
+                face.push_back(static_cast<int>(resolved));
+
+                p = end;
+                while (*p && *p != ' ' && *p != '\t')
+                {
+                    ++p;
+                }
+                while (*p == ' ' || *p == '\t')
+                {
+                    ++p;
+                }
+            }
+
+            for (size_t i = 2; i < face.size(); ++i)
+            {
+                const glm::vec3& a = positions[face[0]];
+                const glm::vec3& b = positions[face[i - 1]];
+                const glm::vec3& c = positions[face[i]];
+                corners.push_back(a);
+                corners.push_back(b);
+                corners.push_back(c);
+                edgeSum += glm::length(b - a) + glm::length(c - b) + glm::length(a - c);
+            }
+        }
+    }
+
+    if (!corners.empty())
+    {
+        meanEdgeLength = static_cast<float>(edgeSum / corners.size());
+    }
+
+    std::cout << "ObjLoader: " << positions.size() << " positions, " << corners.size() / 3
+              << " triangles from " << path << std::endl;
+    return !corners.empty();
+}
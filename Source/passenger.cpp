@@ -2,37 +2,25 @@
 #include "../Header/model.hpp"
 #include "../Header/shader.hpp"
 #include "../Header/wagon.hpp"
-#include "../Header/util.hpp"
 
 #include <GL/glew.h>
 #include <glm/gtc/matrix_transform.hpp>
 
-// Static members for shared seatbelt texture
-unsigned int Passenger::seatbeltTextureID = 0;
-bool Passenger::seatbeltTextureLoaded = false;
+Passenger::Passenger(ModelHandle model, int seatIndex)
+    : model(model), seatIndex(seatIndex)
+{
+}
 
-Passenger::Passenger(const std::string& modelPath, int seatIndex)
-    : seatIndex(seatIndex)
+void Passenger::init(ResourceManager& resources)
 {
-    model = new Model(modelPath);
-    setupSeatbeltMesh();
+    model->upload();
 
     // Load seatbelt texture once (shared by all passengers)
-    if (!seatbeltTextureLoaded) {
-        seatbeltTextureID = loadTexture("res/textures/seatbelt_texture.jpg");
-        seatbeltTextureLoaded = true;
+    seatbeltTexture = resources.loadTexture("res/textures/seatbelt_texture.jpg");
+    if (seatbeltTexture) {
+        seatbeltTexture->upload();
     }
-}
 
-Passenger::~Passenger()
-{
-    delete model;
-    if (seatbeltVAO) glDeleteVertexArrays(1, &seatbeltVAO);
-    if (seatbeltVBO) glDeleteBuffers(1, &seatbeltVBO);
-}
-
-void Passenger::setupSeatbeltMesh()
-{
     // Seatbelt as a diagonal strip across chest (from left shoulder to right hip)
     // Coordinates relative to passenger center, will be transformed with passenger matrix
     const float beltWidth = 0.12f;  // Width of the belt
@@ -56,42 +44,23 @@ void Passenger::setupSeatbeltMesh()
         -0.15f - beltWidth, 0.45f, -beltDepth,   0.0f, 0.0f, -1.0f,   0.0f, 1.0f,
         -0.15f,  0.45f, -beltDepth,   0.0f, 0.0f, -1.0f,   1.0f, 1.0f,
     };
-
-    glGenVertexArrays(1, &seatbeltVAO);
-    glGenBuffers(1, &seatbeltVBO);
-
-    glBindVertexArray(seatbeltVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, seatbeltVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-    int stride = 8 * sizeof(float);
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    glEnableVertexAttribArray(0);
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // UV attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindVertexArray(0);
+    seatbelt = resources.getGeometry("seatbelt", vertices, 8);
 }
 
 void Passenger::drawSeatbelt(Shader& shader, const Wagon& wagon)
 {
     // Use seatbelt texture
     glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, seatbeltTextureID);
+    glBindTexture(GL_TEXTURE_2D, seatbeltTexture ? seatbeltTexture->id : 0);
     shader.setInt("uDiffMap1", 0);
-    shader.setBool("uUseTexture", true);
+    shader.setBool("uUseTexture", seatbeltTexture != nullptr);
 
     // Use same transform as passenger but no extra scaling for belt
     // (belt coordinates are already in passenger's local space relative to SCALE)
     glm::mat4 beltMatrix = calculateModelMatrix(wagon);
     shader.setMat4("uM", beltMatrix);
 
-    glBindVertexArray(seatbeltVAO);
+    glBindVertexArray(seatbelt->VAO);
     glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);  // Front face
     glDrawArrays(GL_TRIANGLE_STRIP, 4, 4);  // Back face
     glBindVertexArray(0);
@@ -101,10 +70,10 @@ glm::mat4 Passenger::calculateModelMatrix(const Wagon& wagon) const
 {
     Wagon::SeatTransform seat = wagon.getSeatWorldTransform(seatIndex);
 
-    glm::vec3 forward = seat.forward;
-    glm::vec3 up = seat.up;
-    glm::vec3 right = glm::normalize(glm::cross(forward, up));
-    up = glm::normalize(glm::cross(right, forward));
+    // Seat frame comes from the wagon's track frame and is already orthonormal
+    const glm::vec3& forward = seat.forward;
+    const glm::vec3& up = seat.up;
+    const glm::vec3& right = seat.right;
 
     // Build rotation matrix from orientation vectors
     glm::mat4 rotation(1.0f);
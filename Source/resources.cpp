@@ -0,0 +1,309 @@
+#include "../Header/resources.hpp"
+#include "../Header/model.hpp"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+
+// Textures are indexed by file and settings together
+std::string textureKey(const std::string& path, const TextureSettings& settings)
+{
+    return path + '|' + (settings.flip ? 'f' : '-') + (settings.repeat ? 'r' : '-') + std::to_string(settings.channels);
+}
+
+// Users of an asset besides the manager
+long userCount(long useCount)
+{
+    return useCount > 0 ? useCount - 1 : 0;
+}
+
+} // namespace
+
+TextureResource::~TextureResource()
+{
+    if (id != 0)
+    {
+        glDeleteTextures(1, &id);
+    }
+    freeImage(image);
+}
+
+bool TextureResource::decode(const std::string& file, const TextureSettings& textureSettings)
+{
+    path = file;
+    settings = textureSettings;
+    bool decoded = decodeImage(path.c_str(), image, settings.channels, settings.flip);
+    width = image.width;
+    height = image.height;
+    channels = image.channels;
+    return decoded;
+}
+
+void TextureResource::upload()
+{
+    if (id != 0)
+    {
+        return;
+    }
+    id = uploadTexture(image, path.c_str(), settings.repeat);
+}
+
+size_t TextureResource::getGpuBytes() const
+{
+    // A full mipmap chain adds a third
+    if (id == 0 || width <= 0)
+    {
+        return 0;
+    }
+    return static_cast<size_t>(width) * height * channels * 4 / 3;
+}
+
+size_t TextureResource::getCpuBytes() const
+{
+    return image.pixels ? static_cast<size_t>(width) * height * channels : 0;
+}
+
+GeometryResource::~GeometryResource()
+{
+    if (VAO != 0)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+    }
+}
+
+size_t GeometryResource::getGpuBytes() const
+{
+    return static_cast<size_t>(vertexCount) * 8 * sizeof(float);
+}
+
+template <typename T>
+std::shared_ptr<ResourceManager::Entry<T>> ResourceManager::findOrAdd(
+    std::unordered_map<std::string, std::shared_ptr<Entry<T>>>& table, const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<Entry<T>>& entry = table[key];
+    if (!entry)
+    {
+        entry.reset(new Entry<T>());
+    }
+    return entry;
+}
+
+ModelHandle ResourceManager::loadModel(const std::string& path)
+{
+    std::shared_ptr<Entry<Model>> entry = findOrAdd(models, path);
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    if (!entry->resource)
+    {
+        ModelHandle model(new Model());
+        if (!model->load(path, false, this))
+        {
+            std::cerr << "Resources: Failed to load model " << path << std::endl;
+            return ModelHandle();
+        }
+        entry->resource = model;
+    }
+    return entry->resource;
+}
+
+TextureHandle ResourceManager::loadTexture(const std::string& path, const TextureSettings& settings)
+{
+    std::shared_ptr<Entry<TextureResource>> entry = findOrAdd(textures, textureKey(path, settings));
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    if (!entry->resource)
+    {
+        TextureHandle texture(new TextureResource());
+        if (!texture->decode(path, settings))
+        {
+            std::cerr << "Resources: Failed to load texture " << path << std::endl;
+            return TextureHandle();
+        }
+        entry->resource = texture;
+    }
+    return entry->resource;
+}
+
+GeometryHandle ResourceManager::getGeometry(const std::string& name, const float* vertices, int vertexCount)
+{
+    std::shared_ptr<Entry<GeometryResource>> entry = findOrAdd(geometries, name);
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    if (!entry->resource)
+    {
+        GeometryHandle geometry(new GeometryResource());
+        geometry->name = name;
+        geometry->vertexCount = vertexCount;
+
+        glGenVertexArrays(1, &geometry->VAO);
+        glGenBuffers(1, &geometry->VBO);
+
+        glBindVertexArray(geometry->VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, geometry->VBO);
+        glBufferData(GL_ARRAY_BUFFER, geometry->getGpuBytes(), vertices, GL_STATIC_DRAW);
+
+        int stride = 8 * sizeof(float);
+        // Position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glEnableVertexAttribArray(0);
+        // Normal attribute
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        // UV attribute
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        glBindVertexArray(0);
+        entry->resource = geometry;
+    }
+    return entry->resource;
+}
+
+size_t ResourceManager::releaseUnused()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t released = 0;
+
+    // Models first, as they hold handles to their textures
+    for (auto it = models.begin(); it != models.end();)
+    {
+        if (it->second->resource.use_count() <= 1)
+        {
+            it = models.erase(it);
+            ++released;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    for (auto it = textures.begin(); it != textures.end();)
+    {
+        if (it->second->resource.use_count() <= 1)
+        {
+            it = textures.erase(it);
+            ++released;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    for (auto it = geometries.begin(); it != geometries.end();)
+    {
+        if (it->second->resource.use_count() <= 1)
+        {
+            it = geometries.erase(it);
+            ++released;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return released;
+}
+
+size_t ResourceManager::getGpuBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for (const auto& model : models)
+    {
+        total += model.second->resource ? model.second->resource->getGpuBytes() : 0;
+    }
+    for (const auto& texture : textures)
+    {
+        total += texture.second->resource ? texture.second->resource->getGpuBytes() : 0;
+    }
+    for (const auto& geometry : geometries)
+    {
+        total += geometry.second->resource ? geometry.second->resource->getGpuBytes() : 0;
+    }
+    return total;
+}
+
+size_t ResourceManager::getCpuBytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t total = 0;
+    for (const auto& model : models)
+    {
+        total += model.second->resource ? model.second->resource->getCpuBytes() : 0;
+    }
+    for (const auto& texture : textures)
+    {
+        total += texture.second->resource ? texture.second->resource->getCpuBytes() : 0;
+    }
+    return total;
+}
+
+void ResourceManager::printReport() const
+{
+    size_t gpuBytes = getGpuBytes();
+    size_t cpuBytes = getCpuBytes();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Resources: " << models.size() << " models, " << textures.size() << " textures, "
+              << geometries.size() << " shared geometries; " << gpuBytes / (1024.0 * 1024.0) << " MB on the GPU, "
+              << cpuBytes / (1024.0 * 1024.0) << " MB on the CPU" << std::endl;
+
+    // The tables are unordered, so sort the rows by name within each kind
+    struct Row
+    {
+        const char* kind;
+        std::string name;
+        long users;
+        size_t gpuBytes;
+        size_t cpuBytes;
+    };
+    std::vector<Row> rows;
+    size_t kindBegin = 0;
+    auto sortKind = [&]() {
+        std::sort(rows.begin() + kindBegin, rows.end(), [](const Row& a, const Row& b) { return a.name < b.name; });
+        kindBegin = rows.size();
+    };
+    for (const auto& model : models)
+    {
+        if (const Model* resource = model.second->resource.get())
+        {
+            rows.push_back({ "model", model.first, userCount(model.second->resource.use_count()),
+                             resource->getGpuBytes(), resource->getCpuBytes() });
+        }
+    }
+    sortKind();
+    for (const auto& texture : textures)
+    {
+        if (const TextureResource* resource = texture.second->resource.get())
+        {
+            rows.push_back({ "texture", resource->path, userCount(texture.second->resource.use_count()),
+                             resource->getGpuBytes(), resource->getCpuBytes() });
+        }
+    }
+    sortKind();
+    for (const auto& geometry : geometries)
+    {
+        if (const GeometryResource* resource = geometry.second->resource.get())
+        {
+            rows.push_back({ "geometry", geometry.first, userCount(geometry.second->resource.use_count()),
+                             resource->getGpuBytes(), 0 });
+        }
+    }
+    sortKind();
+
+    for (const Row& row : rows)
+    {
+        std::cout << "  " << std::left << std::setw(9) << row.kind << std::setw(40) << row.name << std::right
+                  << std::setw(3) << row.users << " users  GPU " << std::setw(9) << row.gpuBytes / 1024.0
+                  << " KB  CPU " << std::setw(9) << row.cpuBytes / 1024.0 << " KB" << std::endl;
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
@@ -0,0 +1,248 @@
+#include "../Header/session.hpp"
+#include "../Header/mappedfile.hpp"
+#include "../Header/telemetry.hpp"
+#include "../Header/wagonstate.hpp"
+#include "../Header/Game/Constants.hpp"
+#include "../Header/Game/RollerCoaster.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Journal file layout: JournalHeader followed by
+//   entries       numEntries * JournalEntry (16 bytes)
+//   stateHashes   numTicks   * uint32
+
+namespace
+{
+
+const char JOURNAL_MAGIC[4] = { 'R', 'C', 'S', 'J' };
+const uint32_t JOURNAL_VERSION = 3;   // 2: state hashes include the wagon's ride events; 3: 16-bit seats
+
+struct JournalHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t trackKey;
+    uint32_t carCount;
+    uint32_t flags;         // Bit 0: physical dynamics at the first tick
+    uint32_t numEntries;
+    uint32_t numTicks;
+};
+
+const uint32_t FLAG_PHYSICAL = 1;
+
+static_assert(sizeof(JournalEntry) == 16, "JournalEntry is written to disk as is");
+
+} // namespace
+
+bool SessionJournal::save(const std::string& path) const
+{
+    JournalHeader header;
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    header.version = JOURNAL_VERSION;
+    header.trackKey = trackKey;
+    header.carCount = carCount;
+    header.flags = physical ? FLAG_PHYSICAL : 0;
+    header.numEntries = static_cast<uint32_t>(entries.size());
+    header.numTicks = static_cast<uint32_t>(stateHashes.size());
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Session: Cannot write journal " << path << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(JournalEntry));
+    out.write(reinterpret_cast<const char*>(stateHashes.data()), stateHashes.size() * sizeof(uint32_t));
+    if (!out)
+    {
+        std::cerr << "Session: Failed writing journal " << path << std::endl;
+        return false;
+    }
+
+    std::cout << "Session: Saved " << stateHashes.size() << " ticks and " << entries.size()
+              << " inputs to " << path << std::endl;
+    return true;
+}
+
+bool SessionJournal::load(const std::string& path)
+{
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() < sizeof(JournalHeader))
+    {
+        std::cerr << "Session: Cannot read journal " << path << std::endl;
+        return false;
+    }
+
+    JournalHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    size_t expectedSize = sizeof(JournalHeader) + static_cast<size_t>(header.numEntries) * sizeof(JournalEntry) +
+                          static_cast<size_t>(header.numTicks) * sizeof(uint32_t);
+    if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 ||
+        header.version != JOURNAL_VERSION || file.size() != expectedSize)
+    {
+        std::cerr << "Session: " << path << " is not a valid journal" << std::endl;
+        return false;
+    }
+
+    const unsigned char* cursor = file.data() + sizeof(JournalHeader);
+    entries.resize(header.numEntries);
+    std::memcpy(entries.data(), cursor, entries.size() * sizeof(JournalEntry));
+    cursor += entries.size() * sizeof(JournalEntry);
+    stateHashes.resize(header.numTicks);
+    std::memcpy(stateHashes.data(), cursor, stateHashes.size() * sizeof(uint32_t));
+
+    trackKey = header.trackKey;
+    carCount = header.carCount;
+    physical = (header.flags & FLAG_PHYSICAL) != 0;
+    return true;
+}
+
+Session::Session(RollerCoaster& game, WagonState& wagon, const TrackPath& path, const TrainDynamics* dynamics)
+    : game(game), wagon(wagon), path(path), dynamics(dynamics), telemetry(nullptr),
+      nextEntry(0), currentTick(0), recording(false), replaying(false), firstMismatch(-1)
+{
+}
+
+void Session::startRecording(uint64_t trackKey)
+{
+    journal = SessionJournal();
+    journal.trackKey = trackKey;
+    journal.carCount = static_cast<uint32_t>(wagon.getCarCount());
+    journal.physical = wagon.hasDynamics();
+    recording = true;
+    replaying = false;
+}
+
+bool Session::startReplay(const SessionJournal& recorded, uint64_t trackKey)
+{
+    if (recorded.trackKey != trackKey || recorded.carCount != static_cast<uint32_t>(wagon.getCarCount()))
+    {
+        std::cerr << "Session: Journal was recorded on a different track or train ("
+                  << recorded.carCount << " cars)" << std::endl;
+        return false;
+    }
+    if (recorded.physical && !dynamics)
+    {
+        std::cerr << "Session: Journal needs the physical dynamics model" << std::endl;
+        return false;
+    }
+
+    journal = recorded;
+    wagon.setDynamics(journal.physical ? dynamics : nullptr);
+    pending.clear();
+    nextEntry = 0;
+    firstMismatch = -1;
+    recording = false;
+    replaying = !journal.stateHashes.empty();
+    std::cout << "Session: Replaying " << journal.stateHashes.size() << " ticks ("
+              << journal.stateHashes.size() * SIM_TIMESTEP << " s) with " << journal.entries.size()
+              << " inputs" << std::endl;
+    return true;
+}
+
+void Session::submit(SessionCommand command, uint16_t arg, float value0, float value1)
+{
+    if (replaying)
+    {
+        return;
+    }
+    JournalEntry entry = { 0, command, 0, arg, { value0, value1 } };
+    pending.push_back(entry);
+}
+
+void Session::apply(const JournalEntry& entry)
+{
+    switch (entry.command)
+    {
+    case SessionCommand::ADD_PASSENGER:
+        game.handleAddPassenger();
+        break;
+    case SessionCommand::SEAT_ACTION:
+        game.handleSeatAction(entry.arg);
+        break;
+    case SessionCommand::START_RIDE:
+        game.handleStartRide();
+        break;
+    case SessionCommand::TOGGLE_DYNAMICS:
+        if (dynamics)
+        {
+            wagon.setDynamics(wagon.hasDynamics() ? nullptr : dynamics);
+            std::cout << (wagon.hasDynamics() ? "DYNAMICS: PHYSICAL" : "DYNAMICS: ARCADE") << std::endl;
+        }
+        break;
+    case SessionCommand::VIEW:
+        viewCommands.push_back(entry);
+        break;
+    }
+}
+
+void Session::tick()
+{
+    viewCommands.clear();
+    if (replaying)
+    {
+        const std::vector<JournalEntry>& entries = journal.entries;
+        while (nextEntry < entries.size() && entries[nextEntry].tick <= currentTick)
+        {
+            apply(entries[nextEntry++]);
+        }
+    }
+    else
+    {
+        for (JournalEntry& entry : pending)
+        {
+            entry.tick = currentTick;
+            apply(entry);
+            if (recording)
+            {
+                journal.entries.push_back(entry);
+            }
+        }
+        pending.clear();
+    }
+
+    game.update(SIM_TIMESTEP);
+    wagon.updatePhysics(path, SIM_TIMESTEP);
+    if (telemetry)
+    {
+        telemetry->sample(wagon, path, currentTick);
+    }
+
+    uint64_t fullHash = hashState();
+    uint32_t hash = static_cast<uint32_t>(fullHash ^ (fullHash >> 32));
+    if (recording)
+    {
+        journal.stateHashes.push_back(hash);
+    }
+    else if (replaying)
+    {
+        if (firstMismatch < 0 && hash != journal.stateHashes[currentTick])
+        {
+            firstMismatch = currentTick;
+            std::cerr << "Session: State differs from the journal at tick " << currentTick
+                      << " (" << currentTick * SIM_TIMESTEP << " s)" << std::endl;
+        }
+        if (currentTick + 1 >= journal.stateHashes.size())
+        {
+            // End of the journal: report and hand control back to live input
+            replaying = false;
+            if (firstMismatch < 0)
+            {
+                std::cout << "Session: Replay matched the journal on all "
+                          << journal.stateHashes.size() << " ticks" << std::endl;
+            }
+        }
+    }
+    ++currentTick;
+}
+
+uint64_t Session::hashState() const
+{
+    uint64_t hash = hashBytes(&currentTick, sizeof(currentTick));
+    hash = wagon.hashState(hash);
+    return game.hashState(hash);
+}
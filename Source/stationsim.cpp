@@ -0,0 +1,507 @@
+#include "../Header/stationsim.hpp"
+#include "../Header/parallel.hpp"
+#include "../Header/trackpath.hpp"
+#include "../Header/wagonstate.hpp"
+#include "../Header/Game/Constants.hpp"
+#include "../Header/Game/RollerCoaster.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <sstream>
+
+namespace
+{
+
+// Lognormal distribution parameterized by its mean and coefficient of variation
+class LognormalTime
+{
+public:
+    LognormalTime(double mean, double cv)
+    {
+        double sigma2 = std::log(1.0 + cv * cv);
+        dist = std::lognormal_distribution<double>(std::log(std::max(mean, 1e-9)) - 0.5 * sigma2, std::sqrt(sigma2));
+    }
+
+    double operator()(std::mt19937_64& rng) { return dist(rng); }
+
+private:
+    std::lognormal_distribution<double> dist;
+};
+
+enum class EventType
+{
+    ARRIVAL,    // A rider joins the queue
+    BOARDED,    // The rider being boarded is seated
+    BUCKLED,    // Everyone on the platform train is buckled
+    DEPART,     // Platform train leaves (TAKEOFF)
+    RETURNED,   // A train is back at the station (OFFBOARDING)
+    UNLOADED    // Everyone has left the platform train
+};
+
+struct Event
+{
+    double time;
+    EventType type;
+    int train;
+
+    bool operator>(const Event& other) const { return time > other.time; }
+};
+
+// What the train on the platform is doing
+enum class PlatformPhase
+{
+    WAITING,    // ONBOARDING with nobody to board
+    BOARDING,
+    BUCKLING,
+    DISPATCH,   // Ready, held for the dispatch interval
+    UNLOADING
+};
+
+} // namespace
+
+StationStats::StationStats()
+    : hours(0.0), arrivals(0), riders(0), dispatches(0), sickRides(0), maxQueue(0.0), queueArea(0.0),
+      capacity(0.0), waitHistogram(WAIT_BINS + 1, 0), queueHistogram(QUEUE_BINS + 1, 0.0)
+{
+}
+
+void StationStats::merge(const StationStats& other)
+{
+    hours += other.hours;
+    arrivals += other.arrivals;
+    riders += other.riders;
+    dispatches += other.dispatches;
+    sickRides += other.sickRides;
+    maxQueue = std::max(maxQueue, other.maxQueue);
+    queueArea += other.queueArea;
+    for (size_t i = 0; i < waitHistogram.size(); ++i)
+    {
+        waitHistogram[i] += other.waitHistogram[i];
+    }
+    for (size_t i = 0; i < queueHistogram.size(); ++i)
+    {
+        queueHistogram[i] += other.queueHistogram[i];
+    }
+}
+
+double StationStats::waitPercentile(double p) const
+{
+    uint64_t total = 0;
+    for (uint64_t count : waitHistogram)
+    {
+        total += count;
+    }
+    if (total == 0)
+    {
+        return 0.0;
+    }
+
+    // Upper edge of the bin holding the p-th rider
+    double target = p * static_cast<double>(total);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < WAIT_BINS; ++i)
+    {
+        seen += waitHistogram[i];
+        if (static_cast<double>(seen) >= target && seen > 0)
+        {
+            return static_cast<double>(i + 1);
+        }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+double StationStats::queuePercentile(double p) const
+{
+    double total = 0.0;
+    for (double t : queueHistogram)
+    {
+        total += t;
+    }
+    if (total <= 0.0)
+    {
+        return 0.0;
+    }
+
+    double target = p * total;
+    double seen = 0.0;
+    for (size_t i = 0; i < QUEUE_BINS; ++i)
+    {
+        seen += queueHistogram[i];
+        if (seen >= target)
+        {
+            return static_cast<double>(i);
+        }
+    }
+    return std::numeric_limits<double>::infinity();
+}
+
+double StationStats::meanQueue() const
+{
+    // From the exact area rather than the histogram, so long queues are not clipped
+    return hours > 0.0 ? queueArea / (hours * 3600.0) : 0.0;
+}
+
+StationSimulator::StationSimulator(const StationConfig& config, const RideTimings& timings)
+    : config(config), timings(timings)
+{
+}
+
+RideTimings StationSimulator::calibrate(const TrackPath& path, WagonState& wagon, int sickSamples)
+{
+    RideTimings timings = { 0.0, 0.0, {} };
+    if (!path.isInitialized())
+    {
+        return timings;
+    }
+
+    // RollerCoaster logs every transition unless told not to; keep the calibration runs quiet
+    RideConfig config;
+    config.verbose = false;
+    RollerCoaster game(wagon, path, config);
+    const double maxRideTime = 600.0;
+
+    // One rider is enough: ride times do not depend on the load
+    // Returns start to OFFBOARDING, and the last time the ride was still in TAKEOFF or RIDE
+    auto runRide = [&](double sickAt, double& window) {
+        game.handleAddPassenger();
+        game.handleSeatAction(0);
+        game.handleStartRide();
+
+        double t = 0.0;
+        window = 0.0;
+        while (game.getState() != GameState::OFFBOARDING && t < maxRideTime)
+        {
+            bool riding = game.getState() == GameState::TAKEOFF || game.getState() == GameState::RIDE;
+            if (riding)
+            {
+                window = t;
+                if (sickAt >= 0.0 && t >= sickAt)
+                {
+                    game.handleSeatAction(0);
+                    sickAt = -1.0;
+                }
+            }
+
+            game.update(SIM_TIMESTEP);
+            wagon.updatePhysics(path, SIM_TIMESTEP);
+            t += SIM_TIMESTEP;
+        }
+
+        game.handleSeatAction(0);  // Rider leaves, back to ONBOARDING
+        return t;
+    };
+
+    timings.rideTime = runRide(-1.0, timings.sickWindow);
+
+    int samples = std::max(sickSamples, 2);
+    timings.sickRideTime.resize(samples);
+    for (int i = 0; i < samples; ++i)
+    {
+        double unused;
+        double sickAt = timings.sickWindow * i / (samples - 1);
+        timings.sickRideTime[i] = runRide(sickAt, unused);
+    }
+    return timings;
+}
+
+double StationSimulator::sickRideTime(double sickAt) const
+{
+    const std::vector<double>& table = timings.sickRideTime;
+    if (table.empty() || timings.sickWindow <= 0.0)
+    {
+        return timings.rideTime;
+    }
+
+    double x = std::min(std::max(sickAt / timings.sickWindow, 0.0), 1.0) * (table.size() - 1);
+    size_t i = std::min(static_cast<size_t>(x), table.size() - 2);
+    double f = x - i;
+    return table[i] + (table[i + 1] - table[i]) * f;
+}
+
+StationStats StationSimulator::runReplication(uint64_t seed, bool saturated) const
+{
+    StationStats stats;
+    std::mt19937_64 rng(seed);
+
+    std::exponential_distribution<double> interArrival(config.arrivalRate / 3600.0);
+    LognormalTime boardTime(config.boardMean, config.boardCv);
+    LognormalTime buckleTime(config.buckleMean, config.buckleCv);
+    LognormalTime unloadTime(config.unloadMean, config.unloadCv);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    const double measureStart = config.warmupHours * 3600.0;
+    const double end = measureStart + config.hours * 3600.0;
+    const int trains = std::max(config.trains, 1);
+    const int seats = std::max(config.seatsPerTrain, 1);
+
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::deque<double> queue;           // Arrival times of waiting riders
+    std::deque<int> trainsWaiting;      // Returned trains held until the platform is free
+    std::vector<int> onboard(trains, 0);
+
+    // Every train starts empty at the station, the first one on the platform
+    int platformTrain = 0;
+    PlatformPhase phase = PlatformPhase::WAITING;
+    for (int t = 1; t < trains; ++t)
+    {
+        trainsWaiting.push_back(t);
+    }
+    double lastDispatch = -config.dispatchInterval;
+
+    auto schedule = [&](double time, EventType type, int train) {
+        events.push(Event{ time, type, train });
+    };
+
+    // ONBOARDING: seat the next rider, or buckle up once the train is full or nobody is waiting
+    auto continueBoarding = [&](double now) {
+        if (platformTrain < 0 || phase != PlatformPhase::WAITING)
+        {
+            return;
+        }
+
+        int train = platformTrain;
+        if ((saturated || !queue.empty()) && onboard[train] < seats)
+        {
+            if (!saturated)
+            {
+                double waited = now - queue.front();
+                queue.pop_front();
+                if (now >= measureStart)
+                {
+                    size_t bin = std::min(static_cast<size_t>(waited), StationStats::WAIT_BINS);
+                    ++stats.waitHistogram[bin];
+                }
+            }
+            phase = PlatformPhase::BOARDING;
+            schedule(now + boardTime(rng), EventType::BOARDED, train);
+        }
+        else if (onboard[train] > 0)
+        {
+            double slowest = 0.0;
+            for (int r = 0; r < onboard[train]; ++r)
+            {
+                slowest = std::max(slowest, buckleTime(rng));
+            }
+            phase = PlatformPhase::BUCKLING;
+            schedule(now + slowest, EventType::BUCKLED, train);
+        }
+    };
+
+    // OFFBOARDING: move a train onto the platform and let its riders out
+    auto enterPlatform = [&](double now, int train) {
+        platformTrain = train;
+        if (onboard[train] > 0)
+        {
+            double total = 0.0;
+            for (int r = 0; r < onboard[train]; ++r)
+            {
+                total += unloadTime(rng);
+            }
+            phase = PlatformPhase::UNLOADING;
+            schedule(now + total, EventType::UNLOADED, train);
+        }
+        else
+        {
+            phase = PlatformPhase::WAITING;
+            continueBoarding(now);
+        }
+    };
+
+    if (saturated)
+    {
+        continueBoarding(0.0);
+    }
+    else
+    {
+        schedule(interArrival(rng), EventType::ARRIVAL, -1);
+    }
+    double lastTime = 0.0;
+
+    while (!events.empty())
+    {
+        Event e = events.top();
+        if (e.time > end)
+        {
+            break;
+        }
+        events.pop();
+
+        // Time-weighted queue length over the measured part of the interval
+        double from = std::max(lastTime, measureStart);
+        if (e.time > from)
+        {
+            size_t bin = std::min(queue.size(), StationStats::QUEUE_BINS);
+            stats.queueHistogram[bin] += e.time - from;
+            stats.queueArea += queue.size() * (e.time - from);
+        }
+        lastTime = e.time;
+        double now = e.time;
+
+        switch (e.type)
+        {
+        case EventType::ARRIVAL:
+            queue.push_back(now);
+            if (now >= measureStart)
+            {
+                ++stats.arrivals;
+                stats.maxQueue = std::max(stats.maxQueue, static_cast<double>(queue.size()));
+            }
+            schedule(now + interArrival(rng), EventType::ARRIVAL, -1);
+            continueBoarding(now);
+            break;
+
+        case EventType::BOARDED:
+            ++onboard[e.train];
+            phase = PlatformPhase::WAITING;
+            continueBoarding(now);
+            break;
+
+        case EventType::BUCKLED:
+            phase = PlatformPhase::DISPATCH;
+            schedule(std::max(now, lastDispatch + config.dispatchInterval), EventType::DEPART, e.train);
+            break;
+
+        case EventType::DEPART:
+        {
+            // TAKEOFF and RIDE, or SLOWDOWN, COOLDOWN and REVERSE if anyone gets sick
+            lastDispatch = now;
+            double pSick = 1.0 - std::pow(1.0 - config.sickProbability, onboard[e.train]);
+            double duration = timings.rideTime;
+            if (uniform(rng) < pSick)
+            {
+                duration = sickRideTime(uniform(rng) * timings.sickWindow);
+                if (now >= measureStart)
+                {
+                    ++stats.sickRides;
+                }
+            }
+            if (now >= measureStart)
+            {
+                ++stats.dispatches;
+            }
+            schedule(now + duration, EventType::RETURNED, e.train);
+
+            platformTrain = -1;
+            if (!trainsWaiting.empty())
+            {
+                int next = trainsWaiting.front();
+                trainsWaiting.pop_front();
+                enterPlatform(now, next);
+            }
+            break;
+        }
+
+        case EventType::RETURNED:
+            if (platformTrain < 0)
+            {
+                enterPlatform(now, e.train);
+            }
+            else
+            {
+                trainsWaiting.push_back(e.train);
+            }
+            break;
+
+        case EventType::UNLOADED:
+            if (now >= measureStart)
+            {
+                stats.riders += onboard[e.train];
+            }
+            onboard[e.train] = 0;
+            phase = PlatformPhase::WAITING;
+            continueBoarding(now);
+            break;
+        }
+    }
+
+    // Queue time up to the end of the run
+    double from = std::max(lastTime, measureStart);
+    if (end > from)
+    {
+        stats.queueHistogram[std::min(queue.size(), StationStats::QUEUE_BINS)] += end - from;
+        stats.queueArea += queue.size() * (end - from);
+    }
+
+    stats.hours = config.hours;
+    return stats;
+}
+
+StationStats StationSimulator::run(int replications) const
+{
+    // The first half are the replications, the second half the same seeds with a saturated queue
+    size_t count = std::max(replications, 1);
+    std::vector<StationStats> results(2 * count);
+    parallelFor(0, results.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            // Well-separated seeds so the replications draw independent streams
+            size_t r = i % count;
+            results[i] = runReplication(config.seed + r * 0x9E3779B97F4A7C15ull, i >= count);
+        }
+    });
+
+    StationStats total = results[0];
+    StationStats saturated = results[count];
+    for (size_t i = 1; i < count; ++i)
+    {
+        total.merge(results[i]);
+        saturated.merge(results[count + i]);
+    }
+    total.capacity = saturated.ridersPerHour();
+    return total;
+}
+
+void StationSimulator::printStats(const StationStats& stats)
+{
+    double dispatchesPerHour = stats.hours > 0.0 ? stats.dispatches / stats.hours : 0.0;
+    double ridersPerDispatch = stats.dispatches > 0 ? static_cast<double>(stats.riders) / stats.dispatches : 0.0;
+
+    std::cout << "Station statistics over " << stats.hours << " simulated hours" << std::endl;
+    std::cout << "  Throughput:     " << stats.ridersPerHour() << " riders/h, " << dispatchesPerHour
+              << " dispatches/h, " << ridersPerDispatch << " riders per dispatch" << std::endl;
+    std::cout << "  Arrivals:       " << stats.arrivalsPerHour() << " riders/h, capacity " << stats.capacity
+              << " riders/h" << std::endl;
+    std::cout << "  Sick rides:     " << stats.sickRides << std::endl;
+
+    if (stats.unstable())
+    {
+        std::cout << "  Queue unstable: arrivals reach " << 100.0 * stats.arrivalsPerHour() / stats.capacity
+                  << "% of capacity, the queue grows by about " << stats.arrivalsPerHour() - stats.ridersPerHour()
+                  << " riders/h (max " << stats.maxQueue << "); wait and queue percentiles not reported" << std::endl;
+        return;
+    }
+
+    // Percentiles past the last bin only have a lower bound
+    auto bounded = [](double value, size_t limit) {
+        std::ostringstream out;
+        if (std::isinf(value))
+        {
+            out << ">= " << limit;
+        }
+        else
+        {
+            out << value;
+        }
+        return out.str();
+    };
+
+    std::cout << "  Wait (s):       p50 " << bounded(stats.waitPercentile(0.5), StationStats::WAIT_BINS)
+              << ", p90 " << bounded(stats.waitPercentile(0.9), StationStats::WAIT_BINS)
+              << ", p99 " << bounded(stats.waitPercentile(0.99), StationStats::WAIT_BINS) << std::endl;
+    std::cout << "  Queue (riders): mean " << stats.meanQueue()
+              << ", p50 " << bounded(stats.queuePercentile(0.5), StationStats::QUEUE_BINS)
+              << ", p90 " << bounded(stats.queuePercentile(0.9), StationStats::QUEUE_BINS)
+              << ", p99 " << bounded(stats.queuePercentile(0.99), StationStats::QUEUE_BINS)
+              << ", max " << stats.maxQueue << std::endl;
+    if (stats.waitOverflow() > 0 || stats.queueOverflow() > 0.0)
+    {
+        std::cout << "  Overflow:       " << stats.waitOverflow() << " riders waited " << StationStats::WAIT_BINS
+                  << " s or more, " << stats.queueOverflow() / 3600.0 << " h with " << StationStats::QUEUE_BINS
+                  << " or more queued" << std::endl;
+    }
+}
@@ -0,0 +1,233 @@
+#include "../Header/sweep.hpp"
+#include "../Header/threadpool.hpp"
+#include "../Header/trackpath.hpp"
+#include "../Header/Game/Constants.hpp"
+#include "../Header/Game/RollerCoaster.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+struct SweepParameter
+{
+    const char* name;
+    float& (*field)(SweepPoint& point);
+};
+
+// In the column order of the CSV file
+const SweepParameter PARAMETERS[] = {
+    { "start_track_t", [](SweepPoint& p) -> float& { return p.ride.startTrackT; } },
+    { "end_track_t", [](SweepPoint& p) -> float& { return p.ride.endTrackT; } },
+    { "max_start_velocity", [](SweepPoint& p) -> float& { return p.ride.maxStartVelocity; } },
+    { "slowdown_deceleration", [](SweepPoint& p) -> float& { return p.ride.slowdownDeceleration; } },
+    { "reverse_velocity", [](SweepPoint& p) -> float& { return p.ride.reverseVelocity; } },
+    { "cooldown_duration", [](SweepPoint& p) -> float& { return p.ride.cooldownDuration; } },
+    { "chain_lift_accel", [](SweepPoint& p) -> float& { return p.arcade.chainLiftAccel; } },
+    { "cruise_speed", [](SweepPoint& p) -> float& { return p.arcade.cruiseSpeed; } },
+    { "gravity_effect", [](SweepPoint& p) -> float& { return p.arcade.gravityEffect; } },
+    { "friction", [](SweepPoint& p) -> float& { return p.arcade.friction; } },
+    { "min_velocity", [](SweepPoint& p) -> float& { return p.arcade.minVelocity; } },
+    { "max_velocity", [](SweepPoint& p) -> float& { return p.arcade.maxVelocity; } },
+};
+
+const SweepParameter* findParameter(const std::string& name)
+{
+    for (const SweepParameter& parameter : PARAMETERS)
+    {
+        if (name == parameter.name)
+        {
+            return &parameter;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+ParameterSweep::ParameterSweep(const TrackPath& path, const WagonState& prototype, const SweepSettings& settings)
+    : path(path), prototype(prototype), settings(settings), lastSteals(0)
+{
+}
+
+bool ParameterSweep::parseRange(const std::string& text, SweepRange& range)
+{
+    size_t equals = text.find('=');
+    if (equals == std::string::npos)
+    {
+        return false;
+    }
+    range.name = text.substr(0, equals);
+
+    const char* cursor = text.c_str() + equals + 1;
+    char* end = nullptr;
+    range.from = std::strtof(cursor, &end);
+    if (end == cursor || *end != ':')
+    {
+        return false;
+    }
+    cursor = end + 1;
+    range.to = std::strtof(cursor, &end);
+    if (end == cursor || *end != ':')
+    {
+        return false;
+    }
+    cursor = end + 1;
+    range.steps = static_cast<int>(std::strtol(cursor, &end, 10));
+    return end != cursor && *end == '\0' && range.steps > 0 && findParameter(range.name) != nullptr;
+}
+
+bool ParameterSweep::addRange(const SweepRange& range)
+{
+    if (!findParameter(range.name) || range.steps < 1)
+    {
+        return false;
+    }
+    ranges.push_back(range);
+    return true;
+}
+
+size_t ParameterSweep::getPointCount() const
+{
+    size_t count = 1;
+    for (const SweepRange& range : ranges)
+    {
+        count *= static_cast<size_t>(range.steps);
+    }
+    return count;
+}
+
+SweepPoint ParameterSweep::getPoint(size_t index) const
+{
+    SweepPoint point;
+    bool endSwept = false;
+    for (size_t r = ranges.size(); r-- > 0;)
+    {
+        endSwept = endSwept || ranges[r].name == "end_track_t";
+        const SweepRange& range = ranges[r];
+        size_t step = index % range.steps;
+        index /= range.steps;
+        float f = range.steps > 1 ? static_cast<float>(step) / (range.steps - 1) : 0.0f;
+        findParameter(range.name)->field(point) = range.from + (range.to - range.from) * f;
+    }
+
+    // Loop completion moves with the station unless it is swept itself
+    if (!endSwept)
+    {
+        float end = point.ride.startTrackT - (START_TRACK_T - END_TRACK_T);
+        point.ride.endTrackT = end < 0.0f ? end + 1.0f : end;
+    }
+
+    // Takeoff ends at a speed the chain lift can reach, or the ride would wait in TAKEOFF forever
+    point.ride.maxStartVelocity = std::min(point.ride.maxStartVelocity, point.arcade.cruiseSpeed);
+    return point;
+}
+
+SweepResult ParameterSweep::runPoint(const SweepPoint& point) const
+{
+    SweepResult result = { point, 0.0, 0.0, 0.0f, false };
+
+    WagonState wagon = prototype;
+    wagon.setArcadeParams(point.arcade);
+    wagon.stop();
+
+    RideConfig config = point.ride;
+    config.verbose = false;
+    RollerCoaster game(wagon, path, config);
+
+    game.handleAddPassenger();
+    game.handleSeatAction(0);
+    game.handleStartRide();
+
+    double t = 0.0;
+    bool sickSent = false;
+    bool onCircuit = true;
+    float peakVelocity = 0.0f;
+    while (game.getState() != GameState::OFFBOARDING && t < settings.maxRideTime)
+    {
+        GameState state = game.getState();
+        if (settings.sickAfter > 0.0f && !sickSent && t >= settings.sickAfter &&
+            (state == GameState::TAKEOFF || state == GameState::RIDE))
+        {
+            game.handleSeatAction(0);
+            sickSent = true;
+        }
+
+        game.update(SIM_TIMESTEP);
+        wagon.updatePhysics(path, SIM_TIMESTEP);
+        t += SIM_TIMESTEP;
+        peakVelocity = std::max(peakVelocity, std::abs(wagon.getVelocity()));
+
+        state = game.getState();
+        if (onCircuit && state != GameState::TAKEOFF && state != GameState::RIDE && state != GameState::SLOWDOWN)
+        {
+            onCircuit = false;
+            result.rideTime = t;
+        }
+    }
+
+    result.completed = game.getState() == GameState::OFFBOARDING;
+    result.cycleTime = t;
+    if (onCircuit)
+    {
+        result.rideTime = t;
+    }
+    result.peakSpeed = peakVelocity * path.getLength() * settings.metresPerUnit;
+    return result;
+}
+
+std::vector<SweepResult> ParameterSweep::run(unsigned int threads)
+{
+    size_t count = getPointCount();
+    std::vector<SweepResult> results(count);
+
+    // One task per ride: rides that time out run far longer than the rest, which stealing evens out
+    WorkStealingPool pool(threads);
+    for (size_t i = 0; i < count; ++i)
+    {
+        pool.submit([this, i, &results]() { results[i] = runPoint(getPoint(i)); });
+    }
+    pool.wait();
+
+    lastSteals = pool.getStealCount();
+    return results;
+}
+
+bool ParameterSweep::writeCsv(const std::string& path, const std::vector<SweepResult>& results)
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+    {
+        std::cerr << "Sweep: Cannot write " << path << std::endl;
+        return false;
+    }
+
+    for (const SweepParameter& parameter : PARAMETERS)
+    {
+        out << parameter.name << ',';
+    }
+    out << "ride_time,cycle_time,peak_speed,completed\n";
+
+    for (const SweepResult& result : results)
+    {
+        SweepPoint point = result.point;
+        for (const SweepParameter& parameter : PARAMETERS)
+        {
+            out << parameter.field(point) << ',';
+        }
+        out << result.rideTime << ',' << result.cycleTime << ',' << result.peakSpeed << ','
+            << (result.completed ? 1 : 0) << '\n';
+    }
+
+    if (!out)
+    {
+        std::cerr << "Sweep: Failed writing " << path << std::endl;
+        return false;
+    }
+    std::cout << "Sweep: Wrote " << results.size() << " configurations to " << path << std::endl;
+    return true;
+}
@@ -0,0 +1,176 @@
+#include "../Header/taskgraph.hpp"
+#include "../Header/threadpool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+
+double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+TaskGraph::TaskGraph(WorkStealingPool& pool)
+    : pool(pool), finished(0), elapsed(0.0)
+{
+}
+
+TaskGraph::TaskId TaskGraph::add(const std::string& name, Affinity affinity, Task task, const std::vector<TaskId>& dependencies)
+{
+    TaskId id = nodes.size();
+    Node node;
+    node.name = name;
+    node.affinity = affinity;
+    node.task = std::move(task);
+    node.waitingFor = 0;
+    node.start = node.end = 0.0;
+    for (TaskId dependency : dependencies)
+    {
+        if (dependency >= id)
+        {
+            std::cerr << "TaskGraph: " << name << " depends on a task added after it, ignoring it" << std::endl;
+            continue;
+        }
+        nodes[dependency].dependents.push_back(id);
+        ++node.waitingFor;
+    }
+    nodes.push_back(std::move(node));
+    return id;
+}
+
+void TaskGraph::run()
+{
+    runStart = std::chrono::steady_clock::now();
+    finished = 0;
+
+    // Roots first; everything else is released by the tasks it depends on
+    for (TaskId id = 0; id < nodes.size(); ++id)
+    {
+        if (nodes[id].waitingFor == 0)
+        {
+            if (nodes[id].affinity == Affinity::WORKER)
+            {
+                pool.submit([this, id]() { execute(id); });
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                mainReady.push_back(id);
+            }
+        }
+    }
+
+    for (;;)
+    {
+        TaskId id;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this]() { return !mainReady.empty() || finished == nodes.size(); });
+            if (mainReady.empty())
+            {
+                break;
+            }
+            id = mainReady.front();
+            mainReady.pop_front();
+        }
+        execute(id);
+    }
+
+    elapsed = millisecondsSince(runStart);
+}
+
+void TaskGraph::execute(TaskId id)
+{
+    Node& node = nodes[id];
+    node.start = millisecondsSince(runStart);
+    node.task();
+    node.end = millisecondsSince(runStart);
+    release(id);
+}
+
+void TaskGraph::release(TaskId id)
+{
+    std::vector<TaskId> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (TaskId dependent : nodes[id].dependents)
+        {
+            if (--nodes[dependent].waitingFor == 0)
+            {
+                if (nodes[dependent].affinity == Affinity::WORKER)
+                {
+                    ready.push_back(dependent);
+                }
+                else
+                {
+                    mainReady.push_back(dependent);
+                }
+            }
+        }
+        ++finished;
+
+        // Notify under the lock: once the last task is counted, run() may return and the graph
+        // be destroyed as soon as the mutex is free. Submitting the dependents below is still
+        // safe, as run() can't finish before they do
+        wake.notify_one();
+    }
+
+    for (TaskId dependent : ready)
+    {
+        pool.submit([this, dependent]() { execute(dependent); });
+    }
+}
+
+double TaskGraph::getWorkerTime() const
+{
+    double total = 0.0;
+    for (const Node& node : nodes)
+    {
+        if (node.affinity == Affinity::WORKER)
+        {
+            total += node.end - node.start;
+        }
+    }
+    return total;
+}
+
+double TaskGraph::getMainTime() const
+{
+    double total = 0.0;
+    for (const Node& node : nodes)
+    {
+        if (node.affinity == Affinity::MAIN)
+        {
+            total += node.end - node.start;
+        }
+    }
+    return total;
+}
+
+void TaskGraph::printTimeline() const
+{
+    std::vector<TaskId> order(nodes.size());
+    for (TaskId id = 0; id < nodes.size(); ++id)
+    {
+        order[id] = id;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](TaskId a, TaskId b) { return nodes[a].start < nodes[b].start; });
+
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1);
+    for (TaskId id : order)
+    {
+        const Node& node = nodes[id];
+        std::cout << "  " << std::setw(8) << node.start << " - " << std::setw(8) << node.end << " ms  "
+                  << (node.affinity == Affinity::MAIN ? "main   " : "worker ") << node.name << std::endl;
+    }
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
@@ -0,0 +1,316 @@
+#include "../Header/telemetry.hpp"
+#include "../Header/trackpath.hpp"
+#include "../Header/wagonstate.hpp"
+
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// Telemetry file layout: FileHeader, then column blocks until the end of the file
+// Each block is a BlockHeader with its row count followed by one column after another:
+//   tick              rows * uint32
+//   seat              rows * uint16
+//   speed             rows * float
+//   gVertical, gLateral, gLongitudinal            rows * float each
+//   jerkVertical, jerkLateral, jerkLongitudinal   rows * float each
+
+namespace
+{
+
+const char TELEMETRY_MAGIC[4] = { 'R', 'C', 'T', 'M' };
+const uint32_t TELEMETRY_VERSION = 1;
+const double STANDARD_GRAVITY = 9.80665;
+
+struct FileHeader
+{
+    char magic[4];
+    uint32_t version;
+    float tickRate;
+    float metresPerUnit;
+    uint32_t floatColumns;  // Float columns after tick and seat in every block
+    uint32_t reserved;
+};
+
+struct BlockHeader
+{
+    uint32_t rows;
+    uint32_t firstTick;
+};
+
+// How long the writer sleeps when the ring is empty
+const std::chrono::milliseconds WRITER_IDLE(2);
+
+} // namespace
+
+Telemetry::Telemetry()
+    : ring(RING_CAPACITY), lastTick(0), lastTrackT(0.0f), lastVelocity(0.0), tickRate(0.0f), metresPerUnit(0.25f), waitWhenFull(false),
+      samplesPushed(0), samplesDropped(0),
+      minVertical(0.0f), maxVertical(0.0f), maxLateral(0.0f), maxLongitudinal(0.0f), maxJerk(0.0f),
+      stopRequested(false), blocksWritten(0)
+{
+}
+
+Telemetry::~Telemetry()
+{
+    stop();
+}
+
+bool Telemetry::start(const std::string& path, float rate, bool wait, float scale)
+{
+    stop();
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Telemetry: Cannot write " << path << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, TELEMETRY_MAGIC, sizeof(TELEMETRY_MAGIC));
+    header.version = TELEMETRY_VERSION;
+    header.tickRate = rate;
+    header.metresPerUnit = scale;
+    header.floatColumns = 7;
+    header.reserved = 0;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    filePath = path;
+    tickRate = rate;
+    metresPerUnit = scale;
+    waitWhenFull = wait;
+    seats.clear();
+    samplesPushed = 0;
+    samplesDropped = 0;
+    minVertical = maxVertical = maxLateral = maxLongitudinal = maxJerk = 0.0f;
+    blocksWritten = 0;
+    block.clear();
+    block.reserve(BLOCK_ROWS);
+    scratch.resize(BLOCK_ROWS);
+
+    stopRequested = false;
+    writer = std::thread(&Telemetry::writerLoop, this);
+    return true;
+}
+
+void Telemetry::stop()
+{
+    if (!writer.joinable())
+    {
+        return;
+    }
+
+    stopRequested = true;
+    writer.join();
+    file.close();
+
+    std::cout << "Telemetry: " << samplesPushed << " samples in " << blocksWritten << " blocks to " << filePath;
+    if (samplesDropped > 0)
+    {
+        std::cout << ", " << samplesDropped << " dropped";
+    }
+    std::cout << std::endl;
+    std::cout << "Telemetry: Vertical " << minVertical << " to " << maxVertical << " g, lateral up to "
+              << maxLateral << " g, longitudinal up to " << maxLongitudinal << " g, jerk up to "
+              << maxJerk << " m/s^3" << std::endl;
+}
+
+void Telemetry::sample(WagonState& wagon, const TrackPath& path, uint32_t tick)
+{
+    if (!writer.joinable())
+    {
+        return;
+    }
+
+    // Seat transforms come from the car poses, so place the cars at this step
+    wagon.interpolate(path, 1.0f);
+
+    double dt = 1.0 / tickRate;
+    double length = path.getLength();
+    double velocity = wagon.getVelocity() * length;
+    float trackT = wagon.getTrackParameter();
+
+    // A train that moved much further than its speed allows was placed, not driven (the game snaps
+    // the wagon back to the station), which is no motion a rider feels
+    double moved = trackT - lastTrackT;
+    moved = (moved - std::floor(moved + 0.5)) * length;
+    bool placed = std::abs(moved) > 2.0 * std::max(std::abs(velocity), std::abs(lastVelocity)) * dt + 1e-3;
+
+    size_t seatCount = static_cast<size_t>(wagon.getCarCount()) * WagonState::SEATS_PER_CAR;
+    if (seats.size() != seatCount || tick != lastTick + 1 || placed)
+    {
+        // New train, a gap in the ticks or a jump: start the history over
+        seats.assign(seatCount, SeatHistory());
+        for (SeatHistory& seat : seats)
+        {
+            seat.valid = false;
+        }
+    }
+    double tangential = seats[0].valid ? (velocity - lastVelocity) / dt : 0.0;
+    lastTick = tick;
+    lastTrackT = trackT;
+    lastVelocity = velocity;
+
+    double scale = metresPerUnit;
+    double smoothing = 1.0 - std::exp(-2.0 * glm::pi<double>() * FILTER_BANDWIDTH * dt);
+    glm::dvec3 gravity(0.0, -STANDARD_GRAVITY, 0.0);
+
+    for (int car = 0; car < wagon.getCarCount(); ++car)
+    {
+        // Same placement as WagonState: the cars follow the lead at fixed arc-length offsets
+        float distance = trackT * static_cast<float>(length) - car * wagon.getCarSpacing();
+        if (distance < 0.0f)
+        {
+            distance += static_cast<float>(length);
+        }
+        TrackFrame frame = path.evaluateFrameAtDistance(distance);
+        TrackFrameRates rates = path.evaluateFrameRatesAtDistance(distance);
+
+        // Center line point: dv/dt along the tangent and v^2 curvature toward the normal
+        glm::dvec3 rotation = glm::dvec3(rates.rotation) * velocity;
+        glm::dvec3 center = glm::dvec3(frame.forward) * tangential + glm::dvec3(rates.curvature) * (velocity * velocity);
+
+        for (int i = 0; i < WagonState::SEATS_PER_CAR; ++i)
+        {
+            size_t s = static_cast<size_t>(car) * WagonState::SEATS_PER_CAR + i;
+            WagonState::SeatTransform transform = wagon.getSeatWorldTransform(static_cast<int>(s));
+            SeatHistory& seat = seats[s];
+
+            // The seat rides rigidly on the frame: add the angular and centripetal terms of its offset
+            glm::dvec3 offset = glm::dvec3(transform.position - frame.position);
+            glm::dvec3 angular = seat.valid ? (rotation - seat.rotation) / dt : glm::dvec3(0.0);
+            glm::dvec3 acceleration = (center + glm::cross(angular, offset)
+                                       + glm::cross(rotation, glm::cross(rotation, offset))) * scale;
+
+            if (!seat.valid)
+            {
+                seat.filtered[0] = seat.filtered[1] = acceleration;
+            }
+            glm::dvec3 previous = seat.filtered[1];
+            seat.filtered[0] = seat.filtered[0] + (acceleration - seat.filtered[0]) * smoothing;
+            seat.filtered[1] = seat.filtered[1] + (seat.filtered[0] - seat.filtered[1]) * smoothing;
+            glm::dvec3 filtered = seat.filtered[1];
+            glm::dvec3 jerk = (filtered - previous) / dt;
+            bool primed = seat.valid;
+            seat.rotation = rotation;
+            seat.valid = true;
+            if (!primed)
+            {
+                continue;
+            }
+
+            glm::dvec3 force = filtered - gravity;
+            glm::dvec3 up(transform.up), right(transform.right), forward(transform.forward);
+
+            TelemetrySample out;
+            out.tick = tick;
+            out.seat = static_cast<uint16_t>(s);
+            out.reserved = 0;
+            out.speed = static_cast<float>(std::abs(velocity) * scale);
+            out.gVertical = static_cast<float>(glm::dot(force, up) / STANDARD_GRAVITY);
+            out.gLateral = static_cast<float>(glm::dot(force, right) / STANDARD_GRAVITY);
+            out.gLongitudinal = static_cast<float>(glm::dot(force, forward) / STANDARD_GRAVITY);
+            out.jerkVertical = static_cast<float>(glm::dot(jerk, up));
+            out.jerkLateral = static_cast<float>(glm::dot(jerk, right));
+            out.jerkLongitudinal = static_cast<float>(glm::dot(jerk, forward));
+
+            bool pushed = ring.push(out);
+            while (!pushed && waitWhenFull)
+            {
+                std::this_thread::yield();
+                pushed = ring.push(out);
+            }
+            if (pushed)
+            {
+                ++samplesPushed;
+            }
+            else
+            {
+                ++samplesDropped;
+            }
+
+            minVertical = std::min(minVertical, out.gVertical);
+            maxVertical = std::max(maxVertical, out.gVertical);
+            maxLateral = std::max(maxLateral, std::abs(out.gLateral));
+            maxLongitudinal = std::max(maxLongitudinal, std::abs(out.gLongitudinal));
+            maxJerk = std::max(maxJerk, static_cast<float>(glm::length(jerk)));
+        }
+    }
+}
+
+void Telemetry::writerLoop()
+{
+    for (;;)
+    {
+        // Read the flag first, so a stop that comes in while draining still gets one more pass
+        bool stopping = stopRequested;
+        size_t count = ring.pop(scratch.data(), scratch.size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            block.push_back(scratch[i]);
+            if (block.size() == BLOCK_ROWS)
+            {
+                flushBlock();
+            }
+        }
+
+        if (count == 0)
+        {
+            if (stopping)
+            {
+                break;
+            }
+            std::this_thread::sleep_for(WRITER_IDLE);
+        }
+    }
+    flushBlock();
+}
+
+void Telemetry::flushBlock()
+{
+    if (block.empty())
+    {
+        return;
+    }
+
+    size_t rows = block.size();
+    BlockHeader header = { static_cast<uint32_t>(rows), block[0].tick };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Transpose the rows into columns, one column at a time
+    std::vector<char> column(rows * sizeof(float));
+    uint32_t* ticks = reinterpret_cast<uint32_t*>(column.data());
+    for (size_t i = 0; i < rows; ++i)
+    {
+        ticks[i] = block[i].tick;
+    }
+    file.write(column.data(), rows * sizeof(uint32_t));
+
+    uint16_t* seatColumn = reinterpret_cast<uint16_t*>(column.data());
+    for (size_t i = 0; i < rows; ++i)
+    {
+        seatColumn[i] = block[i].seat;
+    }
+    file.write(column.data(), rows * sizeof(uint16_t));
+
+    float TelemetrySample::* fields[] = {
+        &TelemetrySample::speed,
+        &TelemetrySample::gVertical, &TelemetrySample::gLateral, &TelemetrySample::gLongitudinal,
+        &TelemetrySample::jerkVertical, &TelemetrySample::jerkLateral, &TelemetrySample::jerkLongitudinal
+    };
+    float* values = reinterpret_cast<float*>(column.data());
+    for (float TelemetrySample::* field : fields)
+    {
+        for (size_t i = 0; i < rows; ++i)
+        {
+            values[i] = block[i].*field;
+        }
+        file.write(column.data(), rows * sizeof(float));
+    }
+
+    block.clear();
+    ++blocksWritten;
+}
@@ -0,0 +1,151 @@
+#include "../Header/threadpool.hpp"
+
+namespace
+{
+
+// Pool and deque of the worker running on this thread, so tasks can submit to their own deque
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local unsigned int currentWorker = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned int threads)
+    : queued(0), unfinished(0), steals(0), nextQueue(0), stopping(false)
+{
+    unsigned int count = threads > 0 ? threads : 1;
+    queues.reserve(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        queues.emplace_back(new TaskQueue());
+    }
+    workers.reserve(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    unsigned int index = currentPool == this ? currentWorker : nextQueue++ % size();
+    unfinished.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+        queued.fetch_add(1);
+    }
+
+    // Taking the idle lock orders this against a worker that found nothing and is about to sleep
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+    }
+    wake.notify_one();
+}
+
+void WorkStealingPool::wait()
+{
+    std::unique_lock<std::mutex> lock(idleMutex);
+    done.wait(lock, [this]() { return unfinished.load() == 0; });
+}
+
+void WorkStealingPool::parallelFor(size_t begin, size_t end, size_t minChunk,
+                                   const std::function<void(size_t, size_t)>& fn)
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    size_t count = end - begin;
+    size_t maxChunks = std::max<size_t>(1, count / std::max<size_t>(1, minChunk));
+    size_t numChunks = std::min<size_t>(size(), maxChunks);
+    size_t chunkSize = (count + numChunks - 1) / numChunks;
+    for (size_t c = 1; c < numChunks; ++c)
+    {
+        size_t chunkBegin = begin + c * chunkSize;
+        size_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+        if (chunkBegin >= chunkEnd)
+        {
+            break;
+        }
+        submit([&fn, chunkBegin, chunkEnd]() { fn(chunkBegin, chunkEnd); });
+    }
+
+    fn(begin, std::min(end, begin + chunkSize));
+    wait();
+}
+
+bool WorkStealingPool::takeTask(unsigned int index, Task& task)
+{
+    // Own deque first, newest task first
+    {
+        TaskQueue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // Then the oldest task of the next worker that has one
+    unsigned int count = size();
+    for (unsigned int offset = 1; offset < count; ++offset)
+    {
+        TaskQueue& victim = *queues[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued.fetch_sub(1);
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned int index)
+{
+    currentPool = this;
+    currentWorker = index;
+
+    for (;;)
+    {
+        Task task;
+        if (takeTask(index, task))
+        {
+            task();
+            if (unfinished.fetch_sub(1) == 1)
+            {
+                std::lock_guard<std::mutex> lock(idleMutex);
+                done.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex);
+        wake.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        if (stopping)
+        {
+            return;
+        }
+    }
+}
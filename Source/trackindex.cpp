@@ -0,0 +1,454 @@
+#include "../Header/trackindex.hpp"
+#include "../Header/trackpath.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+const int MAX_STACK = 64;
+
+float boxDistanceSq(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec3& p)
+{
+    glm::vec3 d = glm::max(glm::max(boundsMin - p, p - boundsMax), glm::vec3(0.0f));
+    return glm::dot(d, d);
+}
+
+// Slab test; tEnter is where the ray enters the box (0 if it starts inside)
+bool rayBox(const glm::vec3& origin, const glm::vec3& invDir, const glm::vec3& boundsMin,
+            const glm::vec3& boundsMax, float maxT, float& tEnter)
+{
+    glm::vec3 t0 = (boundsMin - origin) * invDir;
+    glm::vec3 t1 = (boundsMax - origin) * invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+
+    tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+    return tEnter <= tExit;
+}
+
+// Closest approach between the ray origin + dir * s (s in [0, maxT], dir normalized) and the
+// segment a + (b - a) * u (u in [0, 1])
+float rayEdgeDistanceSq(const glm::vec3& origin, const glm::vec3& dir, float maxT,
+                        const glm::vec3& a, const glm::vec3& b, float& s, float& u)
+{
+    glm::vec3 e = b - a;
+    glm::vec3 w = origin - a;
+    float ee = glm::dot(e, e);
+    float de = glm::dot(dir, e);
+    float dw = glm::dot(dir, w);
+    float ew = glm::dot(e, w);
+
+    float denom = ee - de * de;
+    if (ee <= 0.0f)
+    {
+        u = 0.0f;
+    }
+    else if (denom > 1e-6f * ee)
+    {
+        u = glm::clamp((ew - de * dw) / denom, 0.0f, 1.0f);
+    }
+    else
+    {
+        // Parallel: any point works, pick the start of the edge
+        u = 0.0f;
+    }
+
+    s = glm::clamp(glm::dot(a + e * u - origin, dir), 0.0f, maxT);
+    if (ee > 0.0f)
+    {
+        u = glm::clamp(glm::dot(origin + dir * s - a, e) / ee, 0.0f, 1.0f);
+    }
+
+    glm::vec3 d = origin + dir * s - (a + e * u);
+    return glm::dot(d, d);
+}
+
+} // namespace
+
+TrackSpatialIndex::TrackSpatialIndex()
+    : path(nullptr), numSegments(0)
+{
+}
+
+void TrackSpatialIndex::clear()
+{
+    path = nullptr;
+    numSegments = 0;
+    nodes.clear();
+    segmentOrder.clear();
+    samples.clear();
+    segmentMin.clear();
+    segmentMax.clear();
+}
+
+void TrackSpatialIndex::build(const TrackPath& trackPath)
+{
+    clear();
+    if (trackPath.getNumPoints() < 2)
+    {
+        return;
+    }
+
+    path = &trackPath;
+    numSegments = trackPath.getNumPoints() - 1;
+
+    // Sample every polyline vertex and the midpoint of every polyline edge in one batch
+    size_t numEdges = static_cast<size_t>(numSegments) * SUBDIVISIONS;
+    size_t numFine = numEdges * 2 + 1;
+    std::vector<float> ts(numFine);
+    for (size_t k = 0; k < numFine; ++k)
+    {
+        ts[k] = static_cast<float>(static_cast<double>(k) / static_cast<double>(numFine - 1));
+    }
+    std::vector<float> x(numFine), y(numFine), z(numFine);
+    trackPath.evaluatePositions(ts.data(), numFine, x.data(), y.data(), z.data());
+
+    samples.resize(numEdges + 1);
+    for (size_t k = 0; k <= numEdges; ++k)
+    {
+        samples[k] = glm::vec3(x[k * 2], y[k * 2], z[k * 2]);
+    }
+
+    // Segment bounds, padded by how far the spline bulges away from its polyline
+    segmentMin.resize(numSegments);
+    segmentMax.resize(numSegments);
+    std::vector<glm::vec3> centers(numSegments);
+    for (int seg = 0; seg < numSegments; ++seg)
+    {
+        size_t first = static_cast<size_t>(seg) * SUBDIVISIONS;
+        glm::vec3 boundsMin = samples[first];
+        glm::vec3 boundsMax = samples[first];
+        float bulge = 0.0f;
+        for (int j = 0; j < SUBDIVISIONS; ++j)
+        {
+            size_t k = first + j;
+            glm::vec3 mid(x[k * 2 + 1], y[k * 2 + 1], z[k * 2 + 1]);
+            bulge = std::max(bulge, glm::length(mid - (samples[k] + samples[k + 1]) * 0.5f));
+            boundsMin = glm::min(boundsMin, samples[k + 1]);
+            boundsMax = glm::max(boundsMax, samples[k + 1]);
+        }
+
+        glm::vec3 pad(bulge * 1.5f + 1e-4f);
+        segmentMin[seg] = boundsMin - pad;
+        segmentMax[seg] = boundsMax + pad;
+        centers[seg] = (boundsMin + boundsMax) * 0.5f;
+    }
+
+    segmentOrder.resize(numSegments);
+    for (int seg = 0; seg < numSegments; ++seg)
+    {
+        segmentOrder[seg] = seg;
+    }
+
+    nodes.reserve(2 * (numSegments / LEAF_SIZE + 1));
+    buildNode(0, numSegments, centers);
+
+    std::cout << "TrackSpatialIndex: " << numSegments << " segments, " << nodes.size() << " nodes" << std::endl;
+}
+
+int TrackSpatialIndex::buildNode(int begin, int end, const std::vector<glm::vec3>& centers)
+{
+    int index = static_cast<int>(nodes.size());
+    nodes.push_back(Node());
+
+    glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+    glm::vec3 centerMin(FLT_MAX), centerMax(-FLT_MAX);
+    for (int i = begin; i < end; ++i)
+    {
+        int seg = segmentOrder[i];
+        boundsMin = glm::min(boundsMin, segmentMin[seg]);
+        boundsMax = glm::max(boundsMax, segmentMax[seg]);
+        centerMin = glm::min(centerMin, centers[seg]);
+        centerMax = glm::max(centerMax, centers[seg]);
+    }
+    nodes[index].boundsMin = boundsMin;
+    nodes[index].boundsMax = boundsMax;
+
+    if (end - begin <= LEAF_SIZE)
+    {
+        nodes[index].first = begin;
+        nodes[index].count = end - begin;
+        return index;
+    }
+
+    // Median split along the longest axis of the segment centers
+    glm::vec3 extent = centerMax - centerMin;
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    int mid = (begin + end) / 2;
+    std::nth_element(segmentOrder.begin() + begin, segmentOrder.begin() + mid, segmentOrder.begin() + end,
+                     [&](int a, int b) { return centers[a][axis] < centers[b][axis]; });
+
+    buildNode(begin, mid, centers);
+    int right = buildNode(mid, end, centers);
+    nodes[index].first = right;
+    nodes[index].count = 0;
+    return index;
+}
+
+float TrackSpatialIndex::segmentDistanceSq(int segment, const glm::vec3& position, float& t) const
+{
+    float best = FLT_MAX;
+    size_t first = static_cast<size_t>(segment) * SUBDIVISIONS;
+    for (int j = 0; j < SUBDIVISIONS; ++j)
+    {
+        const glm::vec3& a = samples[first + j];
+        glm::vec3 e = samples[first + j + 1] - a;
+        float ee = glm::dot(e, e);
+        float u = ee > 0.0f ? glm::clamp(glm::dot(position - a, e) / ee, 0.0f, 1.0f) : 0.0f;
+        glm::vec3 d = a + e * u - position;
+        float distSq = glm::dot(d, d);
+        if (distSq < best)
+        {
+            best = distSq;
+            t = (segment + (j + u) / SUBDIVISIONS) / numSegments;
+        }
+    }
+    return best;
+}
+
+TrackHit TrackSpatialIndex::refine(float t, const glm::vec3& position) const
+{
+    // A few Gauss-Newton steps in arc length, where the tangent has unit speed
+    float length = path->getLength();
+    float distance = path->parameterToDistance(t);
+    glm::vec3 point = path->getPositionAtDistance(distance);
+    glm::vec3 offset = position - point;
+    float bestSq = glm::dot(offset, offset);
+
+    for (int iter = 0; iter < 4 && length > 0.0f; ++iter)
+    {
+        float step = glm::dot(offset, path->getForwardAtDistance(distance));
+        // The track is closed: a step past the seam continues from the other end
+        float next = std::fmod(distance + step, length);
+        if (next < 0.0f)
+        {
+            next += length;
+        }
+        if (next >= length)
+        {
+            next = 0.0f;  // -tiny + length rounding up
+        }
+        glm::vec3 nextPoint = path->getPositionAtDistance(next);
+        glm::vec3 nextOffset = position - nextPoint;
+        float nextSq = glm::dot(nextOffset, nextOffset);
+        if (nextSq >= bestSq)
+        {
+            break;
+        }
+        distance = next;
+        point = nextPoint;
+        offset = nextOffset;
+        bestSq = nextSq;
+    }
+
+    TrackHit hit;
+    hit.t = path->distanceToParameter(distance);
+    hit.distance = distance;
+    hit.position = point;
+    hit.separation = std::sqrt(bestSq);
+    hit.rayDistance = 0.0f;
+    return hit;
+}
+
+TrackHit TrackSpatialIndex::closestPoint(const glm::vec3& position) const
+{
+    if (!isBuilt())
+    {
+        return TrackHit{ 0.0f, 0.0f, position, FLT_MAX, 0.0f };
+    }
+
+    float best = FLT_MAX;
+    float bestT = 0.0f;
+
+    int stack[MAX_STACK];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int index = stack[--top];
+        const Node& node = nodes[index];
+        if (boxDistanceSq(node.boundsMin, node.boundsMax, position) >= best)
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (int i = node.first; i < node.first + node.count; ++i)
+            {
+                float t;
+                float distSq = segmentDistanceSq(segmentOrder[i], position, t);
+                if (distSq < best)
+                {
+                    best = distSq;
+                    bestT = t;
+                }
+            }
+            continue;
+        }
+
+        // Visit the nearer child first so the far one is more likely to be pruned
+        int left = index + 1;
+        int right = node.first;
+        float leftDist = boxDistanceSq(nodes[left].boundsMin, nodes[left].boundsMax, position);
+        float rightDist = boxDistanceSq(nodes[right].boundsMin, nodes[right].boundsMax, position);
+        if (leftDist < rightDist)
+        {
+            std::swap(left, right);
+        }
+        stack[top++] = left;
+        stack[top++] = right;
+    }
+
+    return refine(bestT, position);
+}
+
+void TrackSpatialIndex::segmentsInRadius(const glm::vec3& position, float radius, std::vector<int>& out) const
+{
+    out.clear();
+    if (!isBuilt())
+    {
+        return;
+    }
+
+    float radiusSq = radius * radius;
+    int stack[MAX_STACK];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int index = stack[--top];
+        const Node& node = nodes[index];
+        if (boxDistanceSq(node.boundsMin, node.boundsMax, position) > radiusSq)
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (int i = node.first; i < node.first + node.count; ++i)
+            {
+                float t;
+                if (segmentDistanceSq(segmentOrder[i], position, t) <= radiusSq)
+                {
+                    out.push_back(segmentOrder[i]);
+                }
+            }
+            continue;
+        }
+
+        stack[top++] = index + 1;
+        stack[top++] = node.first;
+    }
+
+    std::sort(out.begin(), out.end());
+}
+
+bool TrackSpatialIndex::raycast(const glm::vec3& origin, const glm::vec3& direction, float radius,
+                                TrackHit& hit, float maxDistance) const
+{
+    float dirLength = glm::length(direction);
+    if (!isBuilt() || dirLength <= 0.0f)
+    {
+        return false;
+    }
+
+    glm::vec3 dir = direction / dirLength;
+    glm::vec3 invDir;
+    for (int c = 0; c < 3; ++c)
+    {
+        invDir[c] = std::abs(dir[c]) > 1e-12f ? 1.0f / dir[c] : (dir[c] < 0.0f ? -1e30f : 1e30f);
+    }
+    glm::vec3 pad(radius);
+
+    float bestEnter = maxDistance;
+    float bestT = 0.0f;
+    float bestS = 0.0f;
+    bool found = false;
+
+    int stack[MAX_STACK];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        int index = stack[--top];
+        const Node& node = nodes[index];
+        float tEnter;
+        if (!rayBox(origin, invDir, node.boundsMin - pad, node.boundsMax + pad, bestEnter, tEnter))
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (int i = node.first; i < node.first + node.count; ++i)
+            {
+                int seg = segmentOrder[i];
+                size_t first = static_cast<size_t>(seg) * SUBDIVISIONS;
+                for (int j = 0; j < SUBDIVISIONS; ++j)
+                {
+                    float s, u;
+                    float distSq = rayEdgeDistanceSq(origin, dir, maxDistance, samples[first + j],
+                                                     samples[first + j + 1], s, u);
+                    if (distSq > radius * radius)
+                    {
+                        continue;
+                    }
+
+                    // Where the ray enters the tube around the center line
+                    float enter = std::max(0.0f, s - std::sqrt(radius * radius - distSq));
+                    if (enter < bestEnter || !found)
+                    {
+                        bestEnter = enter;
+                        bestS = s;
+                        bestT = (seg + (j + u) / SUBDIVISIONS) / numSegments;
+                        found = true;
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Visit the child the ray reaches first last-in, so it is popped next
+        int left = index + 1;
+        int right = node.first;
+        float leftEnter = FLT_MAX, rightEnter = FLT_MAX;
+        bool hitLeft = rayBox(origin, invDir, nodes[left].boundsMin - pad, nodes[left].boundsMax + pad,
+                              bestEnter, leftEnter);
+        bool hitRight = rayBox(origin, invDir, nodes[right].boundsMin - pad, nodes[right].boundsMax + pad,
+                               bestEnter, rightEnter);
+        if (hitLeft && hitRight)
+        {
+            if (leftEnter < rightEnter)
+            {
+                std::swap(left, right);
+            }
+            stack[top++] = left;
+            stack[top++] = right;
+        }
+        else if (hitLeft)
+        {
+            stack[top++] = left;
+        }
+        else if (hitRight)
+        {
+            stack[top++] = right;
+        }
+    }
+
+    if (!found)
+    {
+        return false;
+    }
+
+    hit = refine(bestT, origin + dir * bestS);
+    hit.rayDistance = bestEnter;
+    return true;
+}
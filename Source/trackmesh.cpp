@@ -0,0 +1,449 @@
+#include "../Header/trackmesh.hpp"
+#include "../Header/trackpath.hpp"
+
+#include <GL/glew.h>
+#include <glm/gtc/constants.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace
+{
+
+const int FLOATS_PER_VERTEX = 8;
+
+void pushVertex(std::vector<float>& vertices, const glm::vec3& position, const glm::vec3& normal, float u, float v)
+{
+    vertices.push_back(position.x);
+    vertices.push_back(position.y);
+    vertices.push_back(position.z);
+    vertices.push_back(normal.x);
+    vertices.push_back(normal.y);
+    vertices.push_back(normal.z);
+    vertices.push_back(u);
+    vertices.push_back(v);
+}
+
+glm::vec3 profilePoint(const TrackFrame& frame, const glm::vec2& offset)
+{
+    return frame.position + frame.right * offset.x + frame.up * offset.y;
+}
+
+// Largest distance between the chord of a profile point over [s0, s1] and where that point
+// really is halfway along
+float chordError(const TrackPath& path, float s0, float s1, const std::vector<glm::vec2>& probes)
+{
+    TrackFrame a = path.evaluateFrameAtDistance(s0);
+    TrackFrame b = path.evaluateFrameAtDistance(s1);
+    TrackFrame mid = path.evaluateFrameAtDistance((s0 + s1) * 0.5f);
+
+    float error = 0.0f;
+    for (const glm::vec2& probe : probes)
+    {
+        glm::vec3 chordMid = (profilePoint(a, probe) + profilePoint(b, probe)) * 0.5f;
+        error = std::max(error, glm::length(profilePoint(mid, probe) - chordMid));
+    }
+    return error;
+}
+
+// Distances in [begin, end] where rings are placed. Each step starts at twice the previous one
+// and is halved until every probe stays within tolerance, so density follows curvature and roll.
+void chooseRingDistances(const TrackPath& path, const TrackMeshSettings& settings, float begin, float end,
+                         const std::vector<glm::vec2>& probes, std::vector<float>& distances)
+{
+    distances.clear();
+    distances.push_back(begin);
+
+    float s = begin;
+    float step = settings.maxStep;
+    while (s < end)
+    {
+        step = std::min(step * 2.0f, settings.maxStep);
+        for (;;)
+        {
+            float next = std::min(s + step, end);
+            if (next - s <= settings.minStep || chordError(path, s, next, probes) <= settings.tolerance)
+            {
+                break;
+            }
+            step *= 0.5f;
+        }
+
+        s = std::min(s + step, end);
+        distances.push_back(s);
+    }
+}
+
+// Tube of the given radius around a profile offset, one ring per frame
+void sweepTube(const TrackFrameBatch& frames, const std::vector<float>& distances, const glm::vec2& offset,
+               float radius, int sides, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+    unsigned int base = static_cast<unsigned int>(vertices.size() / FLOATS_PER_VERTEX);
+    size_t numRings = frames.size();
+    float vScale = 1.0f / (2.0f * glm::pi<float>() * radius);
+
+    for (size_t r = 0; r < numRings; ++r)
+    {
+        glm::vec3 position(frames.posX[r], frames.posY[r], frames.posZ[r]);
+        glm::vec3 up(frames.upX[r], frames.upY[r], frames.upZ[r]);
+        glm::vec3 right(frames.rightX[r], frames.rightY[r], frames.rightZ[r]);
+        glm::vec3 center = position + right * offset.x + up * offset.y;
+
+        for (int k = 0; k < sides; ++k)
+        {
+            float angle = 2.0f * glm::pi<float>() * k / sides;
+            glm::vec3 normal = right * std::cos(angle) + up * std::sin(angle);
+            pushVertex(vertices, center + normal * radius, normal,
+                       static_cast<float>(k) / sides, distances[r] * vScale);
+        }
+    }
+
+    for (size_t r = 0; r + 1 < numRings; ++r)
+    {
+        unsigned int ring = base + static_cast<unsigned int>(r * sides);
+        unsigned int nextRing = ring + sides;
+        for (int k = 0; k < sides; ++k)
+        {
+            unsigned int k1 = (k + 1) % sides;
+            indices.push_back(ring + k);
+            indices.push_back(nextRing + k);
+            indices.push_back(ring + k1);
+            indices.push_back(ring + k1);
+            indices.push_back(nextRing + k);
+            indices.push_back(nextRing + k1);
+        }
+    }
+}
+
+// Box centered on a profile offset, aligned with the frame
+void addBox(const TrackFrame& frame, const glm::vec2& offset, const glm::vec3& size,
+            std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+    glm::vec3 center = profilePoint(frame, offset);
+    glm::vec3 axes[3] = { frame.right * (size.x * 0.5f), frame.up * (size.y * 0.5f), frame.forward * (size.z * 0.5f) };
+
+    // One face per axis and sign, 4 vertices each so normals stay flat
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const glm::vec3& n = axes[axis];
+        const glm::vec3& a = axes[(axis + 1) % 3];
+        const glm::vec3& b = axes[(axis + 2) % 3];
+        for (int sign = -1; sign <= 1; sign += 2)
+        {
+            glm::vec3 normal = glm::normalize(n) * static_cast<float>(sign);
+            glm::vec3 faceCenter = center + n * static_cast<float>(sign);
+            unsigned int base = static_cast<unsigned int>(vertices.size() / FLOATS_PER_VERTEX);
+
+            pushVertex(vertices, faceCenter - a - b, normal, 0.0f, 0.0f);
+            pushVertex(vertices, faceCenter + a - b, normal, 1.0f, 0.0f);
+            pushVertex(vertices, faceCenter + a + b, normal, 1.0f, 1.0f);
+            pushVertex(vertices, faceCenter - a + b, normal, 0.0f, 1.0f);
+
+            // Counter-clockwise seen from outside; the track frame (right, up, forward) is left-handed
+            if (sign < 0)
+            {
+                indices.insert(indices.end(), { base, base + 1, base + 2, base, base + 2, base + 3 });
+            }
+            else
+            {
+                indices.insert(indices.end(), { base, base + 2, base + 1, base, base + 3, base + 2 });
+            }
+        }
+    }
+}
+
+// Append the sweep over [begin, end]; ties are included when their center lies in the range
+void generateRange(const TrackPath& path, const TrackMeshSettings& settings, float begin, float end,
+                   bool withTies, std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+    float halfGauge = settings.railGauge * 0.5f;
+    glm::vec2 leftRail(-halfGauge, settings.railHeight);
+    glm::vec2 rightRail(halfGauge, settings.railHeight);
+    glm::vec2 spine(0.0f, -settings.spineDepth);
+
+    // The profile's outermost points bend the most in curves and rolls
+    std::vector<glm::vec2> probes = {
+        glm::vec2(-halfGauge - settings.railRadius, settings.railHeight),
+        glm::vec2(halfGauge + settings.railRadius, settings.railHeight),
+        glm::vec2(0.0f, -settings.spineDepth - settings.spineRadius)
+    };
+
+    std::vector<float> distances;
+    chooseRingDistances(path, settings, begin, end, probes, distances);
+
+    TrackFrameBatch frames;
+    path.evaluateFramesAtDistance(distances.data(), distances.size(), frames);
+
+    // Ties whose centers, (i + 0.5) * tieSpacing, fall in [begin, end)
+    int firstTie = 0, endTie = 0;
+    if (withTies && settings.tieSpacing > 0.0f)
+    {
+        firstTie = static_cast<int>(std::ceil(begin / settings.tieSpacing - 0.5f));
+        endTie = std::min(static_cast<int>(std::ceil(end / settings.tieSpacing - 0.5f)),
+                          static_cast<int>(path.getLength() / settings.tieSpacing));
+    }
+
+    sweepTube(frames, distances, leftRail, settings.railRadius, settings.railSides, vertices, indices);
+    sweepTube(frames, distances, rightRail, settings.railRadius, settings.railSides, vertices, indices);
+    sweepTube(frames, distances, spine, settings.spineRadius, settings.spineSides, vertices, indices);
+
+    glm::vec2 tieOffset(0.0f, settings.railHeight - settings.railRadius - settings.tieSize.y * 0.5f);
+    for (int i = firstTie; i < endTie; ++i)
+    {
+        TrackFrame frame = path.evaluateFrameAtDistance((i + 0.5f) * settings.tieSpacing);
+        addBox(frame, tieOffset, settings.tieSize, vertices, indices);
+    }
+}
+
+// Settings for one level of detail
+TrackMeshSettings lodSettings(const TrackMeshSettings& settings, int lod)
+{
+    TrackMeshSettings level = settings;
+    level.tolerance = settings.tolerance * std::pow(settings.lodToleranceScale, static_cast<float>(lod));
+    level.railSides = std::max(3, settings.railSides - 2 * lod);
+    level.spineSides = std::max(3, settings.spineSides - 2 * lod);
+    return level;
+}
+
+} // namespace
+
+TrackMesh::TrackMesh()
+    : VAO(0), VBO(0), EBO(0), vertexCount(0), fullDetailIndices(0), maxPixelError(1.0f), lastStats()
+{
+}
+
+TrackMesh::~TrackMesh()
+{
+    release();
+}
+
+void TrackMesh::release()
+{
+    releaseBuffers();
+    vertexCount = 0;
+    fullDetailIndices = 0;
+    chunks.clear();
+    lodRanges.clear();
+    lodErrors.clear();
+    lastStats = DrawStats();
+    pendingVertices.clear();
+    pendingIndices.clear();
+}
+
+void TrackMesh::releaseBuffers()
+{
+    if (VAO != 0)
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        VAO = VBO = EBO = 0;
+    }
+}
+
+void TrackMesh::generate(const TrackPath& path, const TrackMeshSettings& settings,
+                         std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+    vertices.clear();
+    indices.clear();
+    if (!path.isInitialized() || path.getLength() <= 0.0f)
+    {
+        return;
+    }
+
+    generateRange(path, settings, 0.0f, path.getLength(), true, vertices, indices);
+}
+
+void TrackMesh::generateLods(const TrackPath& path, const TrackMeshSettings& settings,
+                             std::vector<float>& vertices, std::vector<unsigned int>& indices)
+{
+    vertices.clear();
+    indices.clear();
+    chunks.clear();
+    lodRanges.clear();
+    lodErrors.clear();
+    vertexCount = 0;
+    fullDetailIndices = 0;
+    if (!path.isInitialized() || path.getLength() <= 0.0f)
+    {
+        return;
+    }
+
+    float length = path.getLength();
+    int numChunks = std::max(1, static_cast<int>(length / std::max(settings.chunkLength, 1.0f) + 0.5f));
+    int numLods = glm::clamp(settings.lodCount, 1, MAX_LODS);
+    chunks.resize(numChunks);
+    lodRanges.resize(static_cast<size_t>(numLods) * numChunks);
+
+    for (int lod = 0; lod < numLods; ++lod)
+    {
+        TrackMeshSettings level = lodSettings(settings, lod);
+        bool withTies = lod < 2;
+
+        // Flat tube sides and missing ties add to the sweep tolerance
+        float error = level.tolerance;
+        error = std::max(error, level.railRadius * (1.0f - std::cos(glm::pi<float>() / level.railSides)));
+        error = std::max(error, level.spineRadius * (1.0f - std::cos(glm::pi<float>() / level.spineSides)));
+        if (!withTies)
+        {
+            error = std::max(error, level.tieSize.y);
+        }
+        lodErrors.push_back(error);
+
+        for (int c = 0; c < numChunks; ++c)
+        {
+            float begin = length * c / numChunks;
+            float end = c + 1 == numChunks ? length : length * (c + 1) / numChunks;
+
+            size_t firstVertex = vertices.size() / FLOATS_PER_VERTEX;
+            LodRange& range = lodRanges[static_cast<size_t>(lod) * numChunks + c];
+            range.firstIndex = static_cast<unsigned int>(indices.size());
+            generateRange(path, level, begin, end, withTies, vertices, indices);
+            range.indexCount = static_cast<int>(indices.size() - range.firstIndex);
+
+            // Bounding sphere from the full-detail vertices
+            if (lod == 0)
+            {
+                glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+                for (size_t v = firstVertex; v < vertices.size() / FLOATS_PER_VERTEX; ++v)
+                {
+                    glm::vec3 p(vertices[v * FLOATS_PER_VERTEX], vertices[v * FLOATS_PER_VERTEX + 1],
+                                vertices[v * FLOATS_PER_VERTEX + 2]);
+                    boundsMin = glm::min(boundsMin, p);
+                    boundsMax = glm::max(boundsMax, p);
+                }
+                chunks[c].center = (boundsMin + boundsMax) * 0.5f;
+                chunks[c].radius = glm::length(boundsMax - boundsMin) * 0.5f;
+                fullDetailIndices += range.indexCount;
+            }
+        }
+
+        if (lod == 0)
+        {
+            vertexCount = static_cast<int>(vertices.size() / FLOATS_PER_VERTEX);
+        }
+    }
+}
+
+void TrackMesh::build(const TrackPath& path, const TrackMeshSettings& settings)
+{
+    release();
+    prepare(path, settings);
+    upload();
+}
+
+void TrackMesh::prepare(const TrackPath& path, const TrackMeshSettings& settings)
+{
+    generateLods(path, settings, pendingVertices, pendingIndices);
+    maxPixelError = settings.maxPixelError;
+    lastStats = DrawStats();
+}
+
+void TrackMesh::upload()
+{
+    releaseBuffers();
+
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    vertices.swap(pendingVertices);
+    indices.swap(pendingIndices);
+    if (indices.empty())
+    {
+        std::cerr << "TrackMesh: Nothing to build - track path is empty" << std::endl;
+        return;
+    }
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    // Stride: 8 floats per vertex (pos:3 + normal:3 + uv:2)
+    int stride = FLOATS_PER_VERTEX * sizeof(float);
+
+    // Position - location 0
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Normal - location 1
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // UV - location 2
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+
+    std::cout << "TrackMesh: " << getTriangleCount() << " triangles at full detail, " << getNumChunks()
+              << " chunks x " << lodErrors.size() << " levels, " << vertices.size() / FLOATS_PER_VERTEX
+              << " vertices in total" << std::endl;
+}
+
+void TrackMesh::selectLods(const glm::vec3& cameraPos, float pixelScale, std::vector<int>& lods) const
+{
+    lods.assign(chunks.size(), 0);
+    int numLods = static_cast<int>(lodErrors.size());
+    for (size_t c = 0; c < chunks.size(); ++c)
+    {
+        float distance = std::max(glm::length(chunks[c].center - cameraPos) - chunks[c].radius, 0.001f);
+        for (int lod = numLods - 1; lod > 0; --lod)
+        {
+            if (lodErrors[lod] * pixelScale / distance <= maxPixelError)
+            {
+                lods[c] = lod;
+                break;
+            }
+        }
+    }
+}
+
+void TrackMesh::draw()
+{
+    selectedLods.assign(chunks.size(), 0);
+    draw(selectedLods);
+}
+
+void TrackMesh::draw(const glm::vec3& cameraPos, float pixelScale)
+{
+    selectLods(cameraPos, pixelScale, selectedLods);
+    draw(selectedLods);
+}
+
+void TrackMesh::draw(const std::vector<int>& lods)
+{
+    lastStats = DrawStats();
+    if (VAO == 0)
+    {
+        return;
+    }
+
+    glBindVertexArray(VAO);
+
+    // Runs of neighbouring chunks at the same level are contiguous in the index buffer
+    size_t numChunks = chunks.size();
+    size_t c = 0;
+    while (c < numChunks)
+    {
+        int lod = lods[c];
+        const LodRange& first = lodRanges[lod * numChunks + c];
+        int count = 0;
+        for (; c < numChunks && lods[c] == lod; ++c)
+        {
+            count += lodRanges[lod * numChunks + c].indexCount;
+            lastStats.chunksPerLod[lod]++;
+        }
+
+        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, (void*)(first.firstIndex * sizeof(unsigned int)));
+        lastStats.drawCalls++;
+        lastStats.trianglesSubmitted += count / 3;
+    }
+    lastStats.trianglesFullDetail = fullDetailIndices / 3;
+
+    glBindVertexArray(0);
+}
@@ -1,99 +1,107 @@
 #include "../Header/trackpath.hpp"
-#include "../Header/model.hpp"
+#include "../Header/parallel.hpp"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
 
 TrackPath::TrackPath()
+    : totalLength(0.0f), distanceStep(0.0f)
 {
 }
 
-void TrackPath::extractFromModel(const Model& trackModel, int numSegments, int verticesPerSegment)
+void TrackPath::clear()
 {
     centerPoints.clear();
-    upVectors.clear();
+    arcLengths.clear();
+    distanceToT.clear();
+    frames.clear();
+    totalLength = 0.0f;
+    distanceStep = 0.0f;
+    buildBatchTables();
+}
 
-    // Collect all vertices from all meshes
-    std::vector<glm::vec3> allVertices;
-    for (const auto& mesh : trackModel.meshes)
-    {
-        for (const auto& vertex : mesh.vertices)
-        {
-            allVertices.push_back(vertex.Position);
-        }
-    }
+void TrackPath::extractFromVertices(const std::vector<glm::vec3>& allVertices, float edgeLength,
+                                    int numSegments, int verticesPerSegment)
+{
+    clear();
 
     std::cout << "TrackPath: Total vertices in model: " << allVertices.size() << std::endl;
 
-    if (allVertices.size() < static_cast<size_t>(numSegments * verticesPerSegment))
+    size_t expected = static_cast<size_t>(numSegments) * static_cast<size_t>(verticesPerSegment);
+    if (allVertices.size() < expected)
     {
         std::cerr << "TrackPath: Not enough vertices! Expected "
-                  << (numSegments * verticesPerSegment) << ", got " << allVertices.size() << std::endl;
-        // Adjust if needed
-        numSegments = static_cast<int>(allVertices.size()) / verticesPerSegment;
-        if (numSegments < 2)
+                  << expected << ", got " << allVertices.size() << std::endl;
+        std::cerr << "TrackPath: Falling back to automatic segment detection" << std::endl;
+
+        if (!detectCenterPoints(allVertices, 2.0f * edgeLength))
         {
-            std::cerr << "TrackPath: Cannot extract path - too few vertices" << std::endl;
+            std::cerr << "TrackPath: Cannot extract path - no track found in mesh" << std::endl;
+            clear();
             return;
         }
     }
-
-    // For each segment, calculate the center point (mean of vertices)
-    centerPoints.reserve(numSegments);
-    for (int seg = 0; seg < numSegments; ++seg)
+    else
     {
-        glm::vec3 center(0.0f);
-        int startIdx = seg * verticesPerSegment;
+        averageSegments(allVertices, numSegments, verticesPerSegment);
+    }
 
-        for (int v = 0; v < verticesPerSegment; ++v)
+    finishExtraction();
+}
+
+void TrackPath::averageSegments(const std::vector<glm::vec3>& allVertices, int numSegments, int verticesPerSegment)
+{
+    // For each segment, calculate the center point (mean of vertices)
+    centerPoints.resize(numSegments);
+    parallelFor(0, static_cast<size_t>(numSegments), PARALLEL_GRAIN / verticesPerSegment + 1,
+                [&](size_t begin, size_t end) {
+        for (size_t seg = begin; seg < end; ++seg)
         {
-            center += allVertices[startIdx + v];
+            glm::vec3 center(0.0f);
+            const glm::vec3* segmentVertices = &allVertices[seg * verticesPerSegment];
+
+            for (int v = 0; v < verticesPerSegment; ++v)
+            {
+                center += segmentVertices[v];
+            }
+            center /= static_cast<float>(verticesPerSegment);
+            centerPoints[seg] = center;
         }
-        center /= static_cast<float>(verticesPerSegment);
-        centerPoints.push_back(center);
+    });
+}
+
+void TrackPath::extractFromVerticesAuto(const std::vector<glm::vec3>& allVertices, float edgeLength)
+{
+    clear();
+
+    std::cout << "TrackPath: Total vertices in model: " << allVertices.size() << std::endl;
+
+    if (!detectCenterPoints(allVertices, 2.0f * edgeLength))
+    {
+        std::cerr << "TrackPath: Cannot extract path - no track found in mesh" << std::endl;
+        clear();
+        return;
     }
 
+    finishExtraction();
+}
+
+void TrackPath::finishExtraction()
+{
     std::cout << "TrackPath: Extracted " << centerPoints.size() << " center points" << std::endl;
 
     // Smooth the center points to remove noise from mesh averaging
-    smoothPoints(centerPoints, 3, 5);  // 3 passes with window size 5
+    smoothPoints(centerPoints, SMOOTH_PASSES, SMOOTH_WINDOW);
 
     std::cout << "TrackPath: Smoothed center points" << std::endl;
 
-    // Calculate up vectors based on track geometry
-    // For each point, estimate up as perpendicular to forward and a reference right
-    upVectors.reserve(numSegments);
-    for (int i = 0; i < numSegments; ++i)
-    {
-        // Get forward direction using neighbors for smoother result
-        glm::vec3 forward;
-        int prev = (i - 1 + numSegments) % numSegments;
-        int next = (i + 1) % numSegments;
-        forward = glm::normalize(centerPoints[next] - centerPoints[prev]);
-
-        // Use world up as reference, compute right, then recompute up
-        glm::vec3 worldUp(0.0f, 1.0f, 0.0f);
-        glm::vec3 right = glm::cross(forward, worldUp);
-
-        // If forward is nearly parallel to worldUp, use a different reference
-        float rightLen = glm::length(right);
-        if (rightLen < 0.001f)
-        {
-            right = glm::vec3(1.0f, 0.0f, 0.0f);
-        }
-        else
-        {
-            right = right / rightLen;
-        }
+    buildArcLengthTable();
 
-        glm::vec3 up = glm::normalize(glm::cross(right, forward));
-        upVectors.push_back(up);
-    }
-
-    // Smooth the up vectors to prevent wobbling
-    smoothDirections(upVectors, 5, 7);  // 5 passes with window size 7
+    // Bake the orientation frames along the whole track
+    buildFrameTable();
+    buildBatchTables();
 
-    std::cout << "TrackPath: Smoothed up vectors" << std::endl;
+    std::cout << "TrackPath: Track length " << totalLength << " units" << std::endl;
 
     // Print some debug info about the track bounds
     glm::vec3 minBounds(FLT_MAX), maxBounds(-FLT_MAX);
@@ -148,6 +156,43 @@ glm::vec3 TrackPath::catmullRom(const glm::vec3& p0, const glm::vec3& p1,
     return result;
 }
 
+glm::vec3 TrackPath::catmullRomDerivative(const glm::vec3& p0, const glm::vec3& p1,
+                                           const glm::vec3& p2, const glm::vec3& p3, float t) const
+{
+    float t2 = t * t;
+
+    // d/dt of the Catmull-Rom spline formula
+    glm::vec3 result = 0.5f * (
+        (-p0 + p2) +
+        (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * (2.0f * t) +
+        (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * (3.0f * t2)
+    );
+
+    return result;
+}
+
+glm::vec3 TrackPath::catmullRomSecondDerivative(const glm::vec3& p0, const glm::vec3& p1,
+                                                 const glm::vec3& p2, const glm::vec3& p3, float t) const
+{
+    // d2/dt2 of the Catmull-Rom spline formula
+    glm::vec3 result = 0.5f * (
+        (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * 2.0f +
+        (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * (6.0f * t)
+    );
+
+    return result;
+}
+
+void TrackPath::getControlIndices(int index, int& i0, int& i1, int& i2, int& i3) const
+{
+    // Get 4 control points for Catmull-Rom (handle boundaries)
+    int n = static_cast<int>(centerPoints.size());
+    i0 = (index - 1 + n) % n;
+    i1 = index;
+    i2 = (index + 1) % n;
+    i3 = (index + 2) % n;
+}
+
 glm::vec3 TrackPath::getPosition(float t) const
 {
     if (centerPoints.empty())
@@ -164,13 +209,8 @@ glm::vec3 TrackPath::getPosition(float t) const
     float localT;
     getSegmentInfo(t, index, localT);
 
-    int n = static_cast<int>(centerPoints.size());
-
-    // Get 4 control points for Catmull-Rom (handle boundaries)
-    int i0 = (index - 1 + n) % n;
-    int i1 = index;
-    int i2 = (index + 1) % n;
-    int i3 = (index + 2) % n;
+    int i0, i1, i2, i3;
+    getControlIndices(index, i0, i1, i2, i3);
 
     return catmullRom(centerPoints[i0], centerPoints[i1],
                       centerPoints[i2], centerPoints[i3], localT);
@@ -183,15 +223,15 @@ glm::vec3 TrackPath::getForward(float t) const
         return glm::vec3(0.0f, 0.0f, 1.0f);
     }
 
-    // Calculate tangent by getting positions slightly before and after
-    float delta = 0.001f;
-    float t1 = glm::clamp(t - delta, 0.0f, 1.0f);
-    float t2 = glm::clamp(t + delta, 0.0f, 1.0f);
+    int index;
+    float localT;
+    getSegmentInfo(t, index, localT);
 
-    glm::vec3 p1 = getPosition(t1);
-    glm::vec3 p2 = getPosition(t2);
+    int i0, i1, i2, i3;
+    getControlIndices(index, i0, i1, i2, i3);
 
-    glm::vec3 forward = p2 - p1;
+    glm::vec3 forward = catmullRomDerivative(centerPoints[i0], centerPoints[i1],
+                                             centerPoints[i2], centerPoints[i3], localT);
     float len = glm::length(forward);
 
     if (len > 0.0001f)
@@ -204,105 +244,409 @@ glm::vec3 TrackPath::getForward(float t) const
 
 glm::vec3 TrackPath::getUp(float t) const
 {
-    if (upVectors.empty())
+    return sampleFrame(parameterToDistance(t)) * glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+glm::vec3 TrackPath::getRight(float t) const
+{
+    return evaluateFrame(t).right;
+}
+
+TrackFrame TrackPath::evaluateFrame(float t) const
+{
+    return evaluateFrame(t, parameterToDistance(t));
+}
+
+TrackFrame TrackPath::evaluateFrame(float t, float distance) const
+{
+    TrackFrame frame;
+    frame.position = centerPoints.empty() ? glm::vec3(0.0f) : centerPoints[0];
+    frame.forward = glm::vec3(0.0f, 0.0f, 1.0f);
+    frame.up = sampleFrame(distance) * glm::vec3(0.0f, 1.0f, 0.0f);
+
+    if (centerPoints.size() >= 2)
     {
-        return glm::vec3(0.0f, 1.0f, 0.0f);
+        int index;
+        float localT;
+        getSegmentInfo(t, index, localT);
+
+        int i0, i1, i2, i3;
+        getControlIndices(index, i0, i1, i2, i3);
+
+        const glm::vec3& p0 = centerPoints[i0];
+        const glm::vec3& p1 = centerPoints[i1];
+        const glm::vec3& p2 = centerPoints[i2];
+        const glm::vec3& p3 = centerPoints[i3];
+
+        frame.position = catmullRom(p0, p1, p2, p3, localT);
+
+        glm::vec3 tangent = catmullRomDerivative(p0, p1, p2, p3, localT);
+        float len = glm::length(tangent);
+        if (len > 0.0001f)
+        {
+            frame.forward = tangent / len;
+        }
     }
 
-    if (upVectors.size() == 1)
+    // Orthonormalize the baked up against the exact tangent: right from forward x up, then recompute up
+    glm::vec3 right = glm::cross(frame.forward, frame.up);
+    float rightLen = glm::length(right);
+    if (rightLen < 0.0001f)
     {
-        return upVectors[0];
+        right = glm::cross(frame.forward, glm::vec3(1.0f, 0.0f, 0.0f));
+        rightLen = glm::length(right);
     }
+    frame.right = right / rightLen;
+    frame.up = glm::cross(frame.right, frame.forward);
 
-    int index;
-    float localT;
-    getSegmentInfo(t, index, localT);
+    return frame;
+}
 
-    int n = static_cast<int>(upVectors.size());
+glm::quat TrackPath::sampleFrame(float distance) const
+{
+    if (frames.empty())
+    {
+        return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    }
 
-    // Use Catmull-Rom interpolation for smooth up vector transitions
-    int i0 = (index - 1 + n) % n;
-    int i1 = index;
-    int i2 = (index + 1) % n;
-    int i3 = (index + 2) % n;
+    if (frames.size() == 1 || distanceStep <= 0.0f)
+    {
+        return frames[0];
+    }
 
-    glm::vec3 up = catmullRom(upVectors[i0], upVectors[i1],
-                               upVectors[i2], upVectors[i3], localT);
-    return glm::normalize(up);
-}
+    float scaled = glm::clamp(distance, 0.0f, totalLength) / distanceStep;
+    int index = static_cast<int>(scaled);
+    if (index >= static_cast<int>(frames.size()) - 1)
+    {
+        return frames.back();
+    }
 
-glm::vec3 TrackPath::getRight(float t) const
-{
-    glm::vec3 forward = getForward(t);
-    glm::vec3 up = getUp(t);
-    return glm::normalize(glm::cross(forward, up));
+    return glm::slerp(frames[index], frames[index + 1], scaled - index);
 }
 
-void TrackPath::smoothPoints(std::vector<glm::vec3>& points, int passes, int windowSize)
+void TrackPath::buildFrameTable()
 {
-    if (points.size() < 3) return;
-
-    int n = static_cast<int>(points.size());
-    int halfWindow = windowSize / 2;
+    frames.clear();
 
-    for (int pass = 0; pass < passes; ++pass)
+    if (distanceToT.size() < 2)
     {
-        std::vector<glm::vec3> smoothed(n);
+        return;
+    }
+
+    const glm::vec3 worldUp(0.0f, 1.0f, 0.0f);
+    int numSamples = static_cast<int>(distanceToT.size());
+    frames.reserve(numSamples);
 
-        for (int i = 0; i < n; ++i)
+    // Spline samples are independent; only the transport below is sequential
+    std::vector<glm::vec3> samplePositions(numSamples);
+    std::vector<glm::vec3> sampleForwards(numSamples);
+    parallelFor(0, static_cast<size_t>(numSamples), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k)
         {
-            glm::vec3 sum(0.0f);
-            float totalWeight = 0.0f;
+            samplePositions[k] = getPosition(distanceToT[k]);
+            sampleForwards[k] = getForward(distanceToT[k]);
+        }
+    });
 
-            for (int j = -halfWindow; j <= halfWindow; ++j)
+    glm::vec3 prevPos = samplePositions[0];
+    glm::vec3 prevForward = sampleForwards[0];
+    glm::vec3 up = worldUp;
+    if (std::abs(glm::dot(prevForward, up)) > 0.999f)
+    {
+        up = glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+
+    for (int k = 0; k < numSamples; ++k)
+    {
+        const glm::vec3& pos = samplePositions[k];
+        const glm::vec3& forward = sampleForwards[k];
+
+        // Carry the previous up along the curve with the double reflection method,
+        // which gives a rotation minimizing frame with no twist of its own
+        if (k > 0)
+        {
+            glm::vec3 v1 = pos - prevPos;
+            float c1 = glm::dot(v1, v1);
+            if (c1 > 1e-12f)
             {
-                // Use modulo for closed loop track
-                int idx = (i + j + n) % n;
+                glm::vec3 upL = up - (2.0f / c1) * glm::dot(v1, up) * v1;
+                glm::vec3 forwardL = prevForward - (2.0f / c1) * glm::dot(v1, prevForward) * v1;
+                glm::vec3 v2 = forward - forwardL;
+                float c2 = glm::dot(v2, v2);
+                up = c2 > 1e-12f ? upL - (2.0f / c2) * glm::dot(v2, upL) * v2 : upL;
+            }
+        }
 
-                // Gaussian-like weight (closer points have more influence)
-                float weight = 1.0f / (1.0f + std::abs(j) * 0.5f);
-                sum += points[idx] * weight;
-                totalWeight += weight;
+        // Banking: pull toward the world-up frame wherever it is well defined, so the track
+        // stays level without drift; vertical sections keep the transported frame.
+        // The reference keeps the transported side so inverted sections stay inverted.
+        glm::vec3 levelRight = glm::cross(forward, worldUp);
+        float horizontal = glm::length(levelRight);
+        float weight = glm::clamp((horizontal - 0.15f) / 0.45f, 0.0f, 1.0f);
+        if (weight > 0.0f)
+        {
+            glm::vec3 levelUp = glm::cross(levelRight / horizontal, forward);
+            if (glm::dot(levelUp, up) < 0.0f)
+            {
+                levelUp = -levelUp;
             }
+            weight = weight * weight * (3.0f - 2.0f * weight);
+            up = glm::mix(up, levelUp, weight);
+        }
+
+        // Orthonormalize against the tangent
+        glm::vec3 right = glm::normalize(glm::cross(forward, up));
+        up = glm::cross(right, forward);
 
-            smoothed[i] = sum / totalWeight;
+        // right = forward x up makes (right, up, forward) left-handed, so store the proper
+        // rotation with columns (-right, up, forward) instead
+        glm::quat q = glm::quat_cast(glm::mat3(-right, up, forward));
+        if (!frames.empty() && glm::dot(q, frames.back()) < 0.0f)
+        {
+            q = -q;  // Keep neighbours in the same hemisphere for interpolation
         }
+        frames.push_back(q);
 
-        points = smoothed;
+        prevPos = pos;
+        prevForward = forward;
     }
 }
 
-void TrackPath::smoothDirections(std::vector<glm::vec3>& directions, int passes, int windowSize)
+void TrackPath::buildArcLengthTable()
 {
-    if (directions.size() < 3) return;
+    arcLengths.clear();
+    distanceToT.clear();
+    totalLength = 0.0f;
+    distanceStep = 0.0f;
 
-    int n = static_cast<int>(directions.size());
-    int halfWindow = windowSize / 2;
-
-    for (int pass = 0; pass < passes; ++pass)
+    if (centerPoints.size() < 2)
     {
-        std::vector<glm::vec3> smoothed(n);
+        return;
+    }
+
+    // Forward table: sample the spline densely at uniform t and accumulate chord lengths
+    int numSamples = (static_cast<int>(centerPoints.size()) - 1) * ARC_SAMPLES_PER_SEGMENT + 1;
+    arcLengths.resize(numSamples);
+    arcLengths[0] = 0.0f;
 
-        for (int i = 0; i < n; ++i)
+    // Chord lengths are independent, so compute them in parallel and accumulate afterwards
+    float invLast = 1.0f / static_cast<float>(numSamples - 1);
+    parallelFor(1, static_cast<size_t>(numSamples), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        glm::vec3 prev = getPosition((begin - 1) * invLast);
+        for (size_t i = begin; i < end; ++i)
         {
-            glm::vec3 sum(0.0f);
-            float totalWeight = 0.0f;
+            glm::vec3 p = getPosition(i * invLast);
+            arcLengths[i] = glm::length(p - prev);
+            prev = p;
+        }
+    });
+    for (int i = 1; i < numSamples; ++i)
+    {
+        arcLengths[i] += arcLengths[i - 1];
+    }
+    totalLength = arcLengths.back();
 
-            for (int j = -halfWindow; j <= halfWindow; ++j)
-            {
-                // Use modulo for closed loop track
-                int idx = (i + j + n) % n;
+    if (totalLength <= 0.0f)
+    {
+        return;
+    }
 
-                // Gaussian-like weight
-                float weight = 1.0f / (1.0f + std::abs(j) * 0.5f);
-                sum += directions[idx] * weight;
-                totalWeight += weight;
+    // Inverse table: t at uniform distances, found by walking the forward table once
+    distanceToT.resize(numSamples);
+    distanceStep = totalLength / static_cast<float>(numSamples - 1);
+
+    // Each chunk binary-searches its first entry, then walks the forward table
+    parallelFor(0, static_cast<size_t>(numSamples), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        float firstS = begin * distanceStep;
+        int j = static_cast<int>(std::lower_bound(arcLengths.begin() + 1, arcLengths.end(), firstS) -
+                                 (arcLengths.begin() + 1));
+        j = std::min(j, numSamples - 2);
+
+        for (size_t k = begin; k < end; ++k)
+        {
+            float s = k * distanceStep;
+            while (j < numSamples - 2 && arcLengths[j + 1] < s)
+            {
+                ++j;
             }
 
-            // Normalize since we're averaging direction vectors
-            smoothed[i] = glm::normalize(sum / totalWeight);
+            float span = arcLengths[j + 1] - arcLengths[j];
+            float f = span > 0.0f ? glm::clamp((s - arcLengths[j]) / span, 0.0f, 1.0f) : 0.0f;
+            distanceToT[k] = (j + f) * invLast;
         }
+    });
+    distanceToT.back() = 1.0f;
+}
+
+float TrackPath::parameterToDistance(float t) const
+{
+    if (arcLengths.size() < 2)
+    {
+        return 0.0f;
+    }
+
+    float scaled = glm::clamp(t, 0.0f, 1.0f) * (arcLengths.size() - 1);
+    int index = static_cast<int>(scaled);
+    if (index >= static_cast<int>(arcLengths.size()) - 1)
+    {
+        return totalLength;
+    }
+
+    float f = scaled - index;
+    return arcLengths[index] + (arcLengths[index + 1] - arcLengths[index]) * f;
+}
+
+float TrackPath::distanceToParameter(float distance) const
+{
+    if (distanceToT.size() < 2)
+    {
+        return totalLength > 0.0f ? glm::clamp(distance / totalLength, 0.0f, 1.0f) : 0.0f;
+    }
+
+    float scaled = glm::clamp(distance, 0.0f, totalLength) / distanceStep;
+    int index = static_cast<int>(scaled);
+    if (index >= static_cast<int>(distanceToT.size()) - 1)
+    {
+        return distanceToT.back();
+    }
+
+    float f = scaled - index;
+    return distanceToT[index] + (distanceToT[index + 1] - distanceToT[index]) * f;
+}
+
+glm::vec3 TrackPath::getPositionAtDistance(float distance) const
+{
+    return getPosition(distanceToParameter(distance));
+}
+
+glm::vec3 TrackPath::getForwardAtDistance(float distance) const
+{
+    return getForward(distanceToParameter(distance));
+}
+
+glm::vec3 TrackPath::getUpAtDistance(float distance) const
+{
+    return getUp(distanceToParameter(distance));
+}
+
+glm::vec3 TrackPath::getRightAtDistance(float distance) const
+{
+    return getRight(distanceToParameter(distance));
+}
+
+TrackFrame TrackPath::evaluateFrameAtDistance(float distance) const
+{
+    return evaluateFrame(distanceToParameter(distance), distance);
+}
+
+TrackFrameRates TrackPath::evaluateFrameRatesAtDistance(float distance) const
+{
+    TrackFrameRates rates = { glm::vec3(0.0f), glm::vec3(0.0f) };
+    if (centerPoints.size() < 2)
+    {
+        return rates;
+    }
+
+    int index;
+    float localT;
+    getSegmentInfo(distanceToParameter(distance), index, localT);
+
+    int i0, i1, i2, i3;
+    getControlIndices(index, i0, i1, i2, i3);
+
+    const glm::vec3& p0 = centerPoints[i0];
+    const glm::vec3& p1 = centerPoints[i1];
+    const glm::vec3& p2 = centerPoints[i2];
+    const glm::vec3& p3 = centerPoints[i3];
+
+    // dT/ds = (r'' - (r''.T) T) / |r'|^2 for any parameterization of the curve
+    glm::vec3 first = catmullRomDerivative(p0, p1, p2, p3, localT);
+    float speed2 = glm::dot(first, first);
+    if (speed2 < 1e-8f)
+    {
+        return rates;
+    }
+    glm::vec3 forward = first / std::sqrt(speed2);
+    glm::vec3 second = catmullRomSecondDerivative(p0, p1, p2, p3, localT);
+    rates.curvature = (second - glm::dot(second, forward) * forward) / speed2;
+
+    // Twist about forward from the rotation between the two baked frames around this distance,
+    // which is constant along the slerp between them
+    float twist = 0.0f;
+    if (frames.size() >= 2 && distanceStep > 0.0f)
+    {
+        int k = glm::clamp(static_cast<int>(glm::clamp(distance, 0.0f, totalLength) / distanceStep),
+                           0, static_cast<int>(frames.size()) - 2);
+        glm::quat step = frames[k + 1] * glm::inverse(frames[k]);
+        if (step.w < 0.0f)
+        {
+            step = -step;
+        }
+        glm::vec3 axis(step.x, step.y, step.z);
+        float sinHalf = glm::length(axis);
+        if (sinHalf > 1e-9f)
+        {
+            float angle = 2.0f * std::atan2(sinHalf, step.w);
+            twist = glm::dot(axis / sinHalf, forward) * angle / distanceStep;
+        }
+    }
+
+    rates.rotation = glm::cross(forward, rates.curvature) + twist * forward;
+    return rates;
+}
+
+void TrackPath::smoothPoints(std::vector<glm::vec3>& points, int passes, int windowSize)
+{
+    if (points.size() < 3) return;
+
+    int n = static_cast<int>(points.size());
+    int halfWindow = std::min(windowSize, SMOOTH_WINDOW) / 2;
+
+    // Gaussian-like weights (closer points have more influence), computed once.
+    // totalWeight is summed in the same order as the taps so results match a per-point sum exactly.
+    float weights[SMOOTH_WINDOW];
+    float totalWeight = 0.0f;
+    for (int j = -halfWindow; j <= halfWindow; ++j)
+    {
+        weights[j + halfWindow] = 1.0f / (1.0f + std::abs(j) * 0.5f);
+        totalWeight += weights[j + halfWindow];
+    }
+    const float* w = weights + halfWindow;
+
+    // Ping-pong between points and the scratch buffer, which keeps its capacity between calls
+    std::vector<glm::vec3>& scratch = smoothScratch;
+    scratch.resize(n);
+
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        const glm::vec3* src = points.data();
+        glm::vec3* dst = scratch.data();
+
+        parallelFor(0, static_cast<size_t>(n), PARALLEL_GRAIN, [=](size_t begin, size_t end) {
+            for (int i = static_cast<int>(begin); i < static_cast<int>(end); ++i)
+            {
+                glm::vec3 sum(0.0f);
+
+                if (i >= halfWindow && i + halfWindow < n)
+                {
+                    for (int j = -halfWindow; j <= halfWindow; ++j)
+                    {
+                        sum += src[i + j] * w[j];
+                    }
+                }
+                else
+                {
+                    for (int j = -halfWindow; j <= halfWindow; ++j)
+                    {
+                        // Use modulo for closed loop track
+                        sum += src[(i + j + n) % n] * w[j];
+                    }
+                }
+
+                dst[i] = sum / totalWeight;
+            }
+        });
 
-        directions = smoothed;
+        points.swap(scratch);
     }
 }
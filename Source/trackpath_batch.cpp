@@ -0,0 +1,403 @@
+#include "../Header/trackpath.hpp"
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TRACKPATH_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRACKPATH_SSE2 1
+#endif
+
+// Batched spline evaluation. The kernel below is written once against a small lane type
+// and instantiated for AVX2 (8 lanes), SSE2 (4 lanes) and plain floats (1 lane, used for
+// the remainder and on targets without SIMD). Index arithmetic is done in float, which is
+// exact for any table smaller than 2^24 entries, so only the gathers need integer lanes.
+
+namespace
+{
+
+struct ScalarLane
+{
+    static const int width = 1;
+    float v;
+
+    ScalarLane() : v(0.0f) {}
+    explicit ScalarLane(float x) : v(x) {}
+
+    static ScalarLane load(const float* p) { return ScalarLane(*p); }
+    void store(float* p) const { *p = v; }
+    static ScalarLane gather(const float* base, ScalarLane index) { return ScalarLane(base[static_cast<int>(index.v)]); }
+
+    friend ScalarLane operator+(ScalarLane a, ScalarLane b) { return ScalarLane(a.v + b.v); }
+    friend ScalarLane operator-(ScalarLane a, ScalarLane b) { return ScalarLane(a.v - b.v); }
+    friend ScalarLane operator*(ScalarLane a, ScalarLane b) { return ScalarLane(a.v * b.v); }
+    friend ScalarLane operator/(ScalarLane a, ScalarLane b) { return ScalarLane(a.v / b.v); }
+
+    static ScalarLane min(ScalarLane a, ScalarLane b) { return ScalarLane(a.v < b.v ? a.v : b.v); }
+    static ScalarLane max(ScalarLane a, ScalarLane b) { return ScalarLane(a.v > b.v ? a.v : b.v); }
+    static ScalarLane sqrt(ScalarLane a) { return ScalarLane(std::sqrt(a.v)); }
+    static ScalarLane trunc(ScalarLane a) { return ScalarLane(static_cast<float>(static_cast<int>(a.v))); }
+
+    // Per-lane a < b ? x : y
+    static ScalarLane selectLess(ScalarLane a, ScalarLane b, ScalarLane x, ScalarLane y) { return a.v < b.v ? x : y; }
+};
+
+#ifdef TRACKPATH_SSE2
+struct SseLane
+{
+    static const int width = 4;
+    __m128 v;
+
+    SseLane() : v(_mm_setzero_ps()) {}
+    explicit SseLane(float x) : v(_mm_set1_ps(x)) {}
+    explicit SseLane(__m128 x) : v(x) {}
+
+    static SseLane load(const float* p) { return SseLane(_mm_loadu_ps(p)); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    static SseLane gather(const float* base, SseLane index)
+    {
+        alignas(16) int i[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(i), _mm_cvttps_epi32(index.v));
+        return SseLane(_mm_setr_ps(base[i[0]], base[i[1]], base[i[2]], base[i[3]]));
+    }
+
+    friend SseLane operator+(SseLane a, SseLane b) { return SseLane(_mm_add_ps(a.v, b.v)); }
+    friend SseLane operator-(SseLane a, SseLane b) { return SseLane(_mm_sub_ps(a.v, b.v)); }
+    friend SseLane operator*(SseLane a, SseLane b) { return SseLane(_mm_mul_ps(a.v, b.v)); }
+    friend SseLane operator/(SseLane a, SseLane b) { return SseLane(_mm_div_ps(a.v, b.v)); }
+
+    static SseLane min(SseLane a, SseLane b) { return SseLane(_mm_min_ps(a.v, b.v)); }
+    static SseLane max(SseLane a, SseLane b) { return SseLane(_mm_max_ps(a.v, b.v)); }
+    static SseLane sqrt(SseLane a) { return SseLane(_mm_sqrt_ps(a.v)); }
+    static SseLane trunc(SseLane a) { return SseLane(_mm_cvtepi32_ps(_mm_cvttps_epi32(a.v))); }
+
+    static SseLane selectLess(SseLane a, SseLane b, SseLane x, SseLane y)
+    {
+        __m128 mask = _mm_cmplt_ps(a.v, b.v);
+        return SseLane(_mm_or_ps(_mm_and_ps(mask, x.v), _mm_andnot_ps(mask, y.v)));
+    }
+};
+#endif
+
+#ifdef TRACKPATH_AVX2
+struct AvxLane
+{
+    static const int width = 8;
+    __m256 v;
+
+    AvxLane() : v(_mm256_setzero_ps()) {}
+    explicit AvxLane(float x) : v(_mm256_set1_ps(x)) {}
+    explicit AvxLane(__m256 x) : v(x) {}
+
+    static AvxLane load(const float* p) { return AvxLane(_mm256_loadu_ps(p)); }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    static AvxLane gather(const float* base, AvxLane index)
+    {
+        return AvxLane(_mm256_i32gather_ps(base, _mm256_cvttps_epi32(index.v), 4));
+    }
+
+    friend AvxLane operator+(AvxLane a, AvxLane b) { return AvxLane(_mm256_add_ps(a.v, b.v)); }
+    friend AvxLane operator-(AvxLane a, AvxLane b) { return AvxLane(_mm256_sub_ps(a.v, b.v)); }
+    friend AvxLane operator*(AvxLane a, AvxLane b) { return AvxLane(_mm256_mul_ps(a.v, b.v)); }
+    friend AvxLane operator/(AvxLane a, AvxLane b) { return AvxLane(_mm256_div_ps(a.v, b.v)); }
+
+    static AvxLane min(AvxLane a, AvxLane b) { return AvxLane(_mm256_min_ps(a.v, b.v)); }
+    static AvxLane max(AvxLane a, AvxLane b) { return AvxLane(_mm256_max_ps(a.v, b.v)); }
+    static AvxLane sqrt(AvxLane a) { return AvxLane(_mm256_sqrt_ps(a.v)); }
+    static AvxLane trunc(AvxLane a) { return AvxLane(_mm256_round_ps(a.v, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC)); }
+
+    static AvxLane selectLess(AvxLane a, AvxLane b, AvxLane x, AvxLane y)
+    {
+        return AvxLane(_mm256_blendv_ps(y.v, x.v, _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)));
+    }
+};
+#endif
+
+// Raw views of the TrackPath tables a kernel reads from
+struct BatchTables
+{
+    const float* px; const float* py; const float* pz;
+    int numPoints;
+    const float* arcLengths;
+    int numArc;
+    const float* distanceToT;  // Same length and spacing as the frame table
+    const float* qw; const float* qx; const float* qy; const float* qz;
+    int numFrames;
+    float totalLength;
+    float distanceStep;
+};
+
+// Output pointers for one kernel call; frame pointers may be null for position-only queries
+struct BatchOutput
+{
+    float* px; float* py; float* pz;
+    float* fx; float* fy; float* fz;
+    float* ux; float* uy; float* uz;
+    float* rx; float* ry; float* rz;
+};
+
+template <class V>
+V catmullRom(V p0, V p1, V p2, V p3, V t, V t2, V t3)
+{
+    return V(0.5f) * ((V(2.0f) * p1) +
+                      (p2 - p0) * t +
+                      (V(2.0f) * p0 - V(5.0f) * p1 + V(4.0f) * p2 - p3) * t2 +
+                      (V(3.0f) * (p1 - p2) + p3 - p0) * t3);
+}
+
+template <class V>
+V catmullRomDerivative(V p0, V p1, V p2, V p3, V t, V t2)
+{
+    return V(0.5f) * ((p2 - p0) +
+                      (V(2.0f) * p0 - V(5.0f) * p1 + V(4.0f) * p2 - p3) * (V(2.0f) * t) +
+                      (V(3.0f) * (p1 - p2) + p3 - p0) * (V(3.0f) * t2));
+}
+
+// Linear lookup into a table sampled uniformly over [0, (size - 1) * step]
+template <class V>
+V lookup(const float* table, int size, V scaled)
+{
+    V index = V::min(V::trunc(scaled), V(static_cast<float>(size - 2)));
+    V f = scaled - index;
+    V a = V::gather(table, index);
+    V b = V::gather(table, index + V(1.0f));
+    return a + (b - a) * f;
+}
+
+// Evaluate V::width queries starting at i. Inputs are spline parameters, or distances when
+// byDistance is set.
+template <class V>
+void evaluateBlock(const BatchTables& tb, const float* input, size_t i, bool byDistance, const BatchOutput& out)
+{
+    V zero(0.0f), one(1.0f);
+    V t, distance;
+
+    V in = V::load(input + i);
+    if (byDistance)
+    {
+        distance = V::min(V::max(in, zero), V(tb.totalLength));
+        t = lookup(tb.distanceToT, tb.numFrames, distance / V(tb.distanceStep));
+    }
+    else
+    {
+        t = V::min(V::max(in, zero), one);
+        distance = lookup(tb.arcLengths, tb.numArc, t * V(static_cast<float>(tb.numArc - 1)));
+    }
+
+    // Segment lookup and control point indices, wrapping like the scalar path
+    float n = static_cast<float>(tb.numPoints);
+    V scaled = t * V(n - 1.0f);
+    V i1 = V::min(V::trunc(scaled), V(n - 2.0f));
+    V localT = scaled - i1;
+    V i0 = V::selectLess(i1, V(0.5f), V(n - 1.0f), i1 - one);
+    V i2 = i1 + one;
+    V i3 = V::selectLess(i1 + V(2.0f), V(n), i1 + V(2.0f), zero);
+
+    V t2 = localT * localT;
+    V t3 = t2 * localT;
+
+    V x0 = V::gather(tb.px, i0), x1 = V::gather(tb.px, i1), x2 = V::gather(tb.px, i2), x3 = V::gather(tb.px, i3);
+    V y0 = V::gather(tb.py, i0), y1 = V::gather(tb.py, i1), y2 = V::gather(tb.py, i2), y3 = V::gather(tb.py, i3);
+    V z0 = V::gather(tb.pz, i0), z1 = V::gather(tb.pz, i1), z2 = V::gather(tb.pz, i2), z3 = V::gather(tb.pz, i3);
+
+    catmullRom(x0, x1, x2, x3, localT, t2, t3).store(out.px + i);
+    catmullRom(y0, y1, y2, y3, localT, t2, t3).store(out.py + i);
+    catmullRom(z0, z1, z2, z3, localT, t2, t3).store(out.pz + i);
+
+    if (!out.fx)
+    {
+        return;
+    }
+
+    // Analytic tangent, falling back to +Z where it vanishes
+    V fx = catmullRomDerivative(x0, x1, x2, x3, localT, t2);
+    V fy = catmullRomDerivative(y0, y1, y2, y3, localT, t2);
+    V fz = catmullRomDerivative(z0, z1, z2, z3, localT, t2);
+    V len = V::sqrt(fx * fx + fy * fy + fz * fz);
+    V tiny(0.0001f);
+    V inv = one / V::max(len, tiny);
+    fx = V::selectLess(len, tiny, zero, fx * inv);
+    fy = V::selectLess(len, tiny, zero, fy * inv);
+    fz = V::selectLess(len, tiny, one, fz * inv);
+
+    // Baked frame at this distance, normalized lerp between neighbouring entries
+    V fs = distance / V(tb.distanceStep);
+    V fi = V::min(V::trunc(fs), V(static_cast<float>(tb.numFrames - 2)));
+    V ff = fs - fi;
+    V fj = fi + one;
+    V gf = one - ff;
+    V qw = V::gather(tb.qw, fi) * gf + V::gather(tb.qw, fj) * ff;
+    V qx = V::gather(tb.qx, fi) * gf + V::gather(tb.qx, fj) * ff;
+    V qy = V::gather(tb.qy, fi) * gf + V::gather(tb.qy, fj) * ff;
+    V qz = V::gather(tb.qz, fi) * gf + V::gather(tb.qz, fj) * ff;
+    V qinv = one / V::sqrt(qw * qw + qx * qx + qy * qy + qz * qz);
+    qw = qw * qinv; qx = qx * qinv; qy = qy * qinv; qz = qz * qinv;
+
+    // Rotate local +Y by the quaternion
+    V two(2.0f);
+    V ux = two * (qx * qy - qw * qz);
+    V uy = one - two * (qx * qx + qz * qz);
+    V uz = two * (qy * qz + qw * qx);
+
+    // right = forward x up, then up = right x forward
+    V rx = fy * uz - fz * uy;
+    V ry = fz * ux - fx * uz;
+    V rz = fx * uy - fy * ux;
+    V rlen = V::sqrt(rx * rx + ry * ry + rz * rz);
+
+    // Forward parallel to up: fall back to forward x +X like evaluateFrame
+    rx = V::selectLess(rlen, tiny, zero, rx);
+    ry = V::selectLess(rlen, tiny, fz, ry);
+    rz = V::selectLess(rlen, tiny, zero - fy, rz);
+    V rinv = one / V::max(V::sqrt(rx * rx + ry * ry + rz * rz), tiny);
+    rx = rx * rinv; ry = ry * rinv; rz = rz * rinv;
+
+    fx.store(out.fx + i); fy.store(out.fy + i); fz.store(out.fz + i);
+    (ry * fz - rz * fy).store(out.ux + i);
+    (rz * fx - rx * fz).store(out.uy + i);
+    (rx * fy - ry * fx).store(out.uz + i);
+    rx.store(out.rx + i); ry.store(out.ry + i); rz.store(out.rz + i);
+}
+
+void evaluateAll(const BatchTables& tb, const float* input, size_t count, bool byDistance, const BatchOutput& out)
+{
+    size_t i = 0;
+#if defined(TRACKPATH_AVX2)
+    for (; i + AvxLane::width <= count; i += AvxLane::width)
+    {
+        evaluateBlock<AvxLane>(tb, input, i, byDistance, out);
+    }
+#endif
+#if defined(TRACKPATH_SSE2)
+    for (; i + SseLane::width <= count; i += SseLane::width)
+    {
+        evaluateBlock<SseLane>(tb, input, i, byDistance, out);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        evaluateBlock<ScalarLane>(tb, input, i, byDistance, out);
+    }
+}
+
+} // namespace
+
+void TrackFrameBatch::resize(size_t count)
+{
+    posX.resize(count); posY.resize(count); posZ.resize(count);
+    forwardX.resize(count); forwardY.resize(count); forwardZ.resize(count);
+    upX.resize(count); upY.resize(count); upZ.resize(count);
+    rightX.resize(count); rightY.resize(count); rightZ.resize(count);
+}
+
+void TrackPath::buildBatchTables()
+{
+    size_t n = centerPoints.size();
+    pointsX.resize(n); pointsY.resize(n); pointsZ.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        pointsX[i] = centerPoints[i].x;
+        pointsY[i] = centerPoints[i].y;
+        pointsZ[i] = centerPoints[i].z;
+    }
+
+    size_t m = frames.size();
+    framesW.resize(m); framesX.resize(m); framesY.resize(m); framesZ.resize(m);
+    for (size_t i = 0; i < m; ++i)
+    {
+        framesW[i] = frames[i].w;
+        framesX[i] = frames[i].x;
+        framesY[i] = frames[i].y;
+        framesZ[i] = frames[i].z;
+    }
+}
+
+void TrackPath::evaluatePositions(const float* ts, size_t count, float* outX, float* outY, float* outZ) const
+{
+    float* outputs[12] = { outX, outY, outZ, nullptr, nullptr, nullptr,
+                           nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+    evaluateBatch(ts, count, false, outputs);
+}
+
+void TrackPath::evaluateFrames(const float* ts, size_t count, TrackFrameBatch& out) const
+{
+    out.resize(count);
+    float* outputs[12] = {
+        out.posX.data(), out.posY.data(), out.posZ.data(),
+        out.forwardX.data(), out.forwardY.data(), out.forwardZ.data(),
+        out.upX.data(), out.upY.data(), out.upZ.data(),
+        out.rightX.data(), out.rightY.data(), out.rightZ.data()
+    };
+    evaluateBatch(ts, count, false, outputs);
+}
+
+void TrackPath::evaluateFramesAtDistance(const float* distances, size_t count, TrackFrameBatch& out) const
+{
+    out.resize(count);
+    float* outputs[12] = {
+        out.posX.data(), out.posY.data(), out.posZ.data(),
+        out.forwardX.data(), out.forwardY.data(), out.forwardZ.data(),
+        out.upX.data(), out.upY.data(), out.upZ.data(),
+        out.rightX.data(), out.rightY.data(), out.rightZ.data()
+    };
+    evaluateBatch(distances, count, true, outputs);
+}
+
+void TrackPath::evaluateFramesAtDistance(const float* distances, size_t begin, size_t end, TrackFrameBatch& out) const
+{
+    if (end <= begin)
+    {
+        return;
+    }
+
+    float* outputs[12] = {
+        out.posX.data() + begin, out.posY.data() + begin, out.posZ.data() + begin,
+        out.forwardX.data() + begin, out.forwardY.data() + begin, out.forwardZ.data() + begin,
+        out.upX.data() + begin, out.upY.data() + begin, out.upZ.data() + begin,
+        out.rightX.data() + begin, out.rightY.data() + begin, out.rightZ.data() + begin
+    };
+    evaluateBatch(distances + begin, end - begin, true, outputs);
+}
+
+void TrackPath::evaluateBatch(const float* input, size_t count, bool byDistance, float* const* outputs) const
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    BatchOutput out = {
+        outputs[0], outputs[1], outputs[2], outputs[3], outputs[4], outputs[5],
+        outputs[6], outputs[7], outputs[8], outputs[9], outputs[10], outputs[11]
+    };
+
+    if (centerPoints.size() < 2 || frames.size() < 2)
+    {
+        // Too little data for the kernel, fall back to the single queries
+        for (size_t i = 0; i < count; ++i)
+        {
+            TrackFrame f = byDistance ? evaluateFrameAtDistance(input[i]) : evaluateFrame(input[i]);
+            out.px[i] = f.position.x; out.py[i] = f.position.y; out.pz[i] = f.position.z;
+            if (out.fx)
+            {
+                out.fx[i] = f.forward.x; out.fy[i] = f.forward.y; out.fz[i] = f.forward.z;
+                out.ux[i] = f.up.x; out.uy[i] = f.up.y; out.uz[i] = f.up.z;
+                out.rx[i] = f.right.x; out.ry[i] = f.right.y; out.rz[i] = f.right.z;
+            }
+        }
+        return;
+    }
+
+    BatchTables tb = {
+        pointsX.data(), pointsY.data(), pointsZ.data(), static_cast<int>(centerPoints.size()),
+        arcLengths.data(), static_cast<int>(arcLengths.size()),
+        distanceToT.data(),
+        framesW.data(), framesX.data(), framesY.data(), framesZ.data(), static_cast<int>(frames.size()),
+        totalLength, distanceStep
+    };
+    evaluateAll(tb, input, count, byDistance, out);
+}
@@ -0,0 +1,309 @@
+#include "../Header/trackpath.hpp"
+#include "../Header/parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Microbenchmarks for the track queries, run from the headless tool's --bench-* options.
+// Every loop folds its results into a sum that is printed, so the work can't be optimized away.
+
+namespace
+{
+
+// Parameters spread over the whole track in a scattered order, like many trains at once
+std::vector<float> benchmarkParameters(size_t count)
+{
+    std::vector<float> ts(count);
+    float t = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        ts[i] = t;
+        t += 0.618034f;  // Golden ratio step
+        t -= static_cast<float>(static_cast<int>(t));
+    }
+    return ts;
+}
+
+float frameSum(const TrackFrame& frame)
+{
+    return frame.position.x + frame.forward.y + frame.up.z + frame.right.x;
+}
+
+// A closed, gently rolling loop with a square cross-section of four slightly jittered
+// vertices per segment, about one world unit between segments
+std::vector<glm::vec3> syntheticTrackVertices(size_t numSegments, int verticesPerSegment)
+{
+    std::vector<glm::vec3> vertices(numSegments * verticesPerSegment);
+    float radius = static_cast<float>(numSegments) / 6.2831853f;
+    uint32_t seed = 12345;
+    for (size_t seg = 0; seg < numSegments; ++seg)
+    {
+        float a = 6.2831853f * static_cast<float>(seg) / static_cast<float>(numSegments);
+        glm::vec3 center(radius * std::cos(a), 10.0f * std::sin(3.0f * a), radius * std::sin(a));
+        for (int v = 0; v < verticesPerSegment; ++v)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            float jitter = static_cast<float>(seed >> 8) / 16777216.0f - 0.5f;
+            glm::vec3 offset((v & 1) ? 1.0f : -1.0f, (v & 2) ? 1.0f : -1.0f, 0.0f);
+            vertices[seg * verticesPerSegment + v] = center + offset + glm::vec3(0.1f * jitter);
+        }
+    }
+    return vertices;
+}
+
+// The frame queries as they were before evaluateFrame: a position per query, a tangent from
+// two more positions at t +- 0.001, an up vector Catmull-Rom interpolated from one up per
+// center point, and a right vector that recomputes both
+struct ReferenceTrack
+{
+    std::vector<glm::vec3> points;
+    std::vector<glm::vec3> ups;
+};
+
+ReferenceTrack referenceTrack(const TrackPath& path)
+{
+    ReferenceTrack track;
+    int n = path.getNumPoints();
+    track.points.resize(n);
+    track.ups.resize(n);
+    for (int i = 0; i < n; ++i)
+    {
+        track.points[i] = path.getCenterPoint(i);
+        track.ups[i] = path.getUp(static_cast<float>(i) / static_cast<float>(std::max(1, n - 1)));
+    }
+    return track;
+}
+
+glm::vec3 referenceCatmullRom(const std::vector<glm::vec3>& p, float t)
+{
+    int n = static_cast<int>(p.size());
+    float scaledT = glm::clamp(t, 0.0f, 1.0f) * (n - 1);
+    int index = static_cast<int>(scaledT);
+    float localT = scaledT - index;
+    if (index >= n - 1)
+    {
+        index = n - 2;
+        localT = 1.0f;
+    }
+
+    const glm::vec3& p0 = p[(index - 1 + n) % n];
+    const glm::vec3& p1 = p[index];
+    const glm::vec3& p2 = p[(index + 1) % n];
+    const glm::vec3& p3 = p[(index + 2) % n];
+    float t2 = localT * localT;
+    float t3 = t2 * localT;
+    return 0.5f * ((2.0f * p1) + (-p0 + p2) * localT + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                   (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+}
+
+glm::vec3 referenceForward(const ReferenceTrack& track, float t)
+{
+    const float delta = 0.001f;
+    glm::vec3 forward = referenceCatmullRom(track.points, glm::clamp(t + delta, 0.0f, 1.0f)) -
+                        referenceCatmullRom(track.points, glm::clamp(t - delta, 0.0f, 1.0f));
+    float len = glm::length(forward);
+    return len > 0.0001f ? forward / len : glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+glm::vec3 referenceUp(const ReferenceTrack& track, float t)
+{
+    return glm::normalize(referenceCatmullRom(track.ups, t));
+}
+
+glm::vec3 referenceRight(const ReferenceTrack& track, float t)
+{
+    return glm::normalize(glm::cross(referenceForward(track, t), referenceUp(track, t)));
+}
+
+// The extraction stages as they were first written: one thread, a fresh vector per pass and
+// the tap weights recomputed in the inner loop. The optimized pipeline must match it exactly.
+void referenceExtraction(const std::vector<glm::vec3>& vertices, int numSegments, int verticesPerSegment,
+                         int passes, int windowSize, std::vector<glm::vec3>& points)
+{
+    points.resize(numSegments);
+    for (int seg = 0; seg < numSegments; ++seg)
+    {
+        glm::vec3 center(0.0f);
+        for (int v = 0; v < verticesPerSegment; ++v)
+        {
+            center += vertices[static_cast<size_t>(seg) * verticesPerSegment + v];
+        }
+        points[seg] = center / static_cast<float>(verticesPerSegment);
+    }
+
+    int n = numSegments;
+    int halfWindow = windowSize / 2;
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        std::vector<glm::vec3> smoothed(n);
+        for (int i = 0; i < n; ++i)
+        {
+            glm::vec3 sum(0.0f);
+            float totalWeight = 0.0f;
+            for (int j = -halfWindow; j <= halfWindow; ++j)
+            {
+                float weight = 1.0f / (1.0f + std::abs(j) * 0.5f);
+                sum += points[(i + j + n) % n] * weight;
+                totalWeight += weight;
+            }
+            smoothed[i] = sum / totalWeight;
+        }
+        points = smoothed;
+    }
+}
+
+} // namespace
+
+void benchmarkFrameEvaluation(const TrackPath& path)
+{
+    if (!path.isInitialized())
+    {
+        return;
+    }
+
+    const size_t count = 100000;
+    const int repeats = 10;
+    std::vector<float> ts = benchmarkParameters(count);
+    ReferenceTrack track = referenceTrack(path);
+
+    // Separate queries along the pre-evaluateFrame path, as Wagon and Passenger made them
+    float separateSum = 0.0f;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r)
+    {
+        for (float t : ts)
+        {
+            TrackFrame frame;
+            frame.position = referenceCatmullRom(track.points, t);
+            frame.forward = referenceForward(track, t);
+            frame.up = referenceUp(track, t);
+            frame.right = referenceRight(track, t);
+            separateSum += frameSum(frame);
+        }
+    }
+    std::chrono::duration<double, std::nano> separate = std::chrono::steady_clock::now() - start;
+
+    float fusedSum = 0.0f;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; ++r)
+    {
+        for (float t : ts)
+        {
+            fusedSum += frameSum(path.evaluateFrame(t));
+        }
+    }
+    std::chrono::duration<double, std::nano> fused = std::chrono::steady_clock::now() - start;
+
+    double calls = static_cast<double>(count) * repeats;
+    std::cout << "TrackPath: " << count << " frames x " << repeats << " repeats" << std::endl;
+    std::cout << "  Separate queries: " << separate.count() / calls << " ns/frame (checksum " << separateSum << ")"
+              << std::endl;
+    std::cout << "  evaluateFrame:    " << fused.count() / calls << " ns/frame (checksum " << fusedSum << ")"
+              << std::endl;
+    std::cout << "  Speedup:          x" << separate.count() / fused.count() << std::endl;
+}
+
+void benchmarkBatchEvaluation(const TrackPath& path)
+{
+    if (!path.isInitialized())
+    {
+        return;
+    }
+
+    // Larger runs go through in chunks, so 10M samples don't need half a gigabyte of output
+    const size_t maxChunk = size_t(1) << 20;
+    const size_t counts[] = { 1000, 100000, 10000000 };
+
+    std::cout << "TrackPath: batched frames against evaluateFrame, chunks of up to " << maxChunk << std::endl;
+    for (size_t count : counts)
+    {
+        size_t chunk = std::min(count, maxChunk);
+        int repeats = static_cast<int>(std::max<size_t>(1, 1000000 / count));
+        std::vector<float> ts = benchmarkParameters(chunk);
+        TrackFrameBatch batch;
+        batch.resize(chunk);
+
+        // Scalar path writes the same structure-of-arrays layout
+        float scalarSum = 0.0f;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+        {
+            for (size_t done = 0; done < count; done += chunk)
+            {
+                size_t n = std::min(chunk, count - done);
+                for (size_t i = 0; i < n; ++i)
+                {
+                    TrackFrame frame = path.evaluateFrame(ts[i]);
+                    batch.posX[i] = frame.position.x; batch.posY[i] = frame.position.y; batch.posZ[i] = frame.position.z;
+                    batch.forwardX[i] = frame.forward.x; batch.forwardY[i] = frame.forward.y; batch.forwardZ[i] = frame.forward.z;
+                    batch.upX[i] = frame.up.x; batch.upY[i] = frame.up.y; batch.upZ[i] = frame.up.z;
+                    batch.rightX[i] = frame.right.x; batch.rightY[i] = frame.right.y; batch.rightZ[i] = frame.right.z;
+                }
+                scalarSum += batch.posX[n - 1] + batch.upY[n - 1];
+            }
+        }
+        std::chrono::duration<double> scalar = std::chrono::steady_clock::now() - start;
+
+        float batchSum = 0.0f;
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+        {
+            for (size_t done = 0; done < count; done += chunk)
+            {
+                size_t n = std::min(chunk, count - done);
+                path.evaluateFrames(ts.data(), n, batch);
+                batchSum += batch.posX[n - 1] + batch.upY[n - 1];
+            }
+        }
+        std::chrono::duration<double> batched = std::chrono::steady_clock::now() - start;
+
+        double samples = static_cast<double>(count) * repeats;
+        std::cout << "  " << count << " samples: " << samples / scalar.count() * 1e-6 << " M/s scalar, "
+                  << samples / batched.count() * 1e-6 << " M/s batched (x" << scalar.count() / batched.count()
+                  << ", checksums " << scalarSum << " / " << batchSum << ")" << std::endl;
+    }
+}
+
+void benchmarkTrackExtraction()
+{
+    const int verticesPerSegment = 4;
+    const size_t counts[] = { 300, 3000, 30000, 300000, 3000000, 10000000 };
+
+    std::cout << "TrackPath: segment averaging and " << TrackPath::SMOOTH_PASSES << " smoothing passes, "
+              << verticesPerSegment << " vertices per segment, " << workerCount() << " threads" << std::endl;
+    for (size_t count : counts)
+    {
+        int numSegments = static_cast<int>(count);
+        int repeats = static_cast<int>(std::max<size_t>(1, 300000 / count));
+        std::vector<glm::vec3> vertices = syntheticTrackVertices(count, verticesPerSegment);
+
+        std::vector<glm::vec3> reference;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+        {
+            referenceExtraction(vertices, numSegments, verticesPerSegment,
+                                TrackPath::SMOOTH_PASSES, TrackPath::SMOOTH_WINDOW, reference);
+        }
+        std::chrono::duration<double, std::nano> referenceTime = std::chrono::steady_clock::now() - start;
+
+        TrackPath path;
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repeats; ++r)
+        {
+            path.averageSegments(vertices, numSegments, verticesPerSegment);
+            path.smoothPoints(path.centerPoints, TrackPath::SMOOTH_PASSES, TrackPath::SMOOTH_WINDOW);
+        }
+        std::chrono::duration<double, std::nano> pipelineTime = std::chrono::steady_clock::now() - start;
+
+        bool identical = std::memcmp(reference.data(), path.centerPoints.data(), count * sizeof(glm::vec3)) == 0;
+        double segments = static_cast<double>(count) * repeats;
+        std::cout << "  " << count << " segments: " << referenceTime.count() / segments << " ns/segment reference, "
+                  << pipelineTime.count() / segments << " ns/segment pipeline (x"
+                  << referenceTime.count() / pipelineTime.count() << "), "
+                  << (identical ? "bit-identical" : "MISMATCH") << std::endl;
+    }
+}
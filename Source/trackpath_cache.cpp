@@ -0,0 +1,222 @@
+#include "../Header/trackpath.hpp"
+#include "../Header/mappedfile.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// Cache file layout: CacheHeader followed by the raw float arrays
+//   centerPoints  numPoints  * 3
+//   arcLengths    numArc
+//   distanceToT   numSamples
+//   frames        numSamples * 4 (w, x, y, z)
+
+namespace
+{
+
+const char CACHE_MAGIC[4] = { 'R', 'C', 'T', 'P' };
+
+// Bump whenever the layout or the computation of any stored table changes
+// 2: settings and source stamp in the header; frames with banking and the exact-tangent orthonormalization
+const uint32_t CACHE_VERSION = 2;
+
+struct CacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t key;           // Source contents and settings, see computeCacheKey
+    uint64_t settings;      // Settings alone, checked when the source is missing
+    uint64_t sourceSize;    // Stamp of the source when the cache was written
+    int64_t sourceTime;
+    uint32_t numPoints;
+    uint32_t numArc;
+    uint32_t numSamples;
+    uint32_t reserved;
+    float totalLength;
+    float distanceStep;
+};
+
+size_t payloadSize(const CacheHeader& header)
+{
+    return sizeof(float) * (static_cast<size_t>(header.numPoints) * 3 +
+                            header.numArc +
+                            static_cast<size_t>(header.numSamples) * 5);
+}
+
+} // namespace
+
+uint64_t TrackPath::settingsKey(int numSegments, int verticesPerSegment)
+{
+    // Everything besides the source that changes the extracted output
+    int32_t settings[] = {
+        static_cast<int32_t>(CACHE_VERSION),
+        numSegments,
+        verticesPerSegment,
+        SMOOTH_PASSES,
+        SMOOTH_WINDOW,
+        ARC_SAMPLES_PER_SEGMENT
+    };
+    return hashBytes(settings, sizeof(settings));
+}
+
+uint64_t TrackPath::computeCacheKey(const std::string& sourcePath, int numSegments, int verticesPerSegment)
+{
+    MappedFile source(sourcePath);
+    if (!source.isOpen())
+    {
+        return 0;
+    }
+
+    uint64_t key = hashBytes(source.data(), source.size(), settingsKey(numSegments, verticesPerSegment));
+    return key != 0 ? key : 1;
+}
+
+bool TrackPath::loadFromCache(const std::string& cachePath, const std::string& sourcePath, uint64_t& key,
+                              int numSegments, int verticesPerSegment)
+{
+    MappedFile file(cachePath);
+    if (!file.isOpen() || file.size() < sizeof(CacheHeader))
+    {
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.version != CACHE_VERSION || header.key == 0 ||
+        header.settings != settingsKey(numSegments, verticesPerSegment) ||
+        header.numPoints < 2 || header.numArc < 2 || header.numSamples < 2 ||
+        file.size() != sizeof(CacheHeader) + payloadSize(header))
+    {
+        std::cout << "TrackPath: Cache " << cachePath << " is stale or invalid" << std::endl;
+        return false;
+    }
+
+    // An unchanged stamp is taken as an unchanged source; otherwise its contents decide
+    uint64_t sourceSize = 0;
+    int64_t sourceTime = 0;
+    bool restamp = false;
+    if (!fileStamp(sourcePath, sourceSize, sourceTime))
+    {
+        std::cout << "TrackPath: No " << sourcePath << ", using cache " << cachePath << " as it is" << std::endl;
+    }
+    else if (sourceSize != header.sourceSize || sourceTime != header.sourceTime)
+    {
+        if (computeCacheKey(sourcePath, numSegments, verticesPerSegment) != header.key)
+        {
+            std::cout << "TrackPath: Cache " << cachePath << " is stale" << std::endl;
+            return false;
+        }
+        restamp = true;  // Same contents under a new stamp, e.g. after a checkout
+    }
+
+    clear();
+
+    const unsigned char* cursor = file.data() + sizeof(CacheHeader);
+
+    centerPoints.resize(header.numPoints);
+    for (glm::vec3& p : centerPoints)
+    {
+        std::memcpy(&p.x, cursor, 3 * sizeof(float));
+        cursor += 3 * sizeof(float);
+    }
+
+    arcLengths.resize(header.numArc);
+    std::memcpy(arcLengths.data(), cursor, header.numArc * sizeof(float));
+    cursor += header.numArc * sizeof(float);
+
+    distanceToT.resize(header.numSamples);
+    std::memcpy(distanceToT.data(), cursor, header.numSamples * sizeof(float));
+    cursor += header.numSamples * sizeof(float);
+
+    frames.resize(header.numSamples);
+    for (glm::quat& q : frames)
+    {
+        float wxyz[4];
+        std::memcpy(wxyz, cursor, sizeof(wxyz));
+        cursor += sizeof(wxyz);
+        q = glm::quat(wxyz[0], wxyz[1], wxyz[2], wxyz[3]);
+    }
+
+    totalLength = header.totalLength;
+    distanceStep = header.distanceStep;
+    buildBatchTables();
+
+    key = header.key;
+
+    std::cout << "TrackPath: Loaded " << centerPoints.size() << " center points from cache "
+              << cachePath << std::endl;
+
+    if (restamp)
+    {
+        file.close();
+        saveToCache(cachePath, sourcePath, key, numSegments, verticesPerSegment);
+    }
+    return true;
+}
+
+bool TrackPath::saveToCache(const std::string& cachePath, const std::string& sourcePath, uint64_t key,
+                            int numSegments, int verticesPerSegment) const
+{
+    if (key == 0 || centerPoints.size() < 2 || frames.size() < 2 || distanceToT.size() != frames.size())
+    {
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.key = key;
+    header.settings = settingsKey(numSegments, verticesPerSegment);
+    header.sourceSize = 0;
+    header.sourceTime = 0;
+    fileStamp(sourcePath, header.sourceSize, header.sourceTime);
+    header.numPoints = static_cast<uint32_t>(centerPoints.size());
+    header.numArc = static_cast<uint32_t>(arcLengths.size());
+    header.numSamples = static_cast<uint32_t>(frames.size());
+    header.reserved = 0;
+    header.totalLength = totalLength;
+    header.distanceStep = distanceStep;
+
+    // Write to a temporary file and rename, so a crash never leaves a half-written cache
+    std::string tempPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cerr << "TrackPath: Cannot write cache " << tempPath << std::endl;
+            return false;
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const glm::vec3& p : centerPoints)
+        {
+            out.write(reinterpret_cast<const char*>(&p.x), 3 * sizeof(float));
+        }
+        out.write(reinterpret_cast<const char*>(arcLengths.data()), arcLengths.size() * sizeof(float));
+        out.write(reinterpret_cast<const char*>(distanceToT.data()), distanceToT.size() * sizeof(float));
+        for (const glm::quat& q : frames)
+        {
+            float wxyz[4] = { q.w, q.x, q.y, q.z };
+            out.write(reinterpret_cast<const char*>(wxyz), sizeof(wxyz));
+        }
+
+        if (!out)
+        {
+            std::cerr << "TrackPath: Failed writing cache " << tempPath << std::endl;
+            return false;
+        }
+    }
+
+    std::remove(cachePath.c_str());
+    if (std::rename(tempPath.c_str(), cachePath.c_str()) != 0)
+    {
+        std::cerr << "TrackPath: Cannot replace cache " << cachePath << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    std::cout << "TrackPath: Saved cache " << cachePath << std::endl;
+    return true;
+}
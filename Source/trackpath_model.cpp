@@ -0,0 +1,75 @@
+#include "../Header/trackpath.hpp"
+#include "../Header/model.hpp"
+#include "../Header/parallel.hpp"
+
+// Model front ends for extraction, kept apart so the rest of TrackPath builds without GL
+
+namespace
+{
+
+// Copy the positions of all meshes into one contiguous array
+void gatherVertices(const Model& trackModel, std::vector<glm::vec3>& allVertices)
+{
+    size_t totalVertices = 0;
+    for (const auto& mesh : trackModel.meshes)
+    {
+        totalVertices += mesh.vertices.size();
+    }
+
+    allVertices.resize(totalVertices);
+    size_t offset = 0;
+    for (const auto& mesh : trackModel.meshes)
+    {
+        const Vertex* src = mesh.vertices.data();
+        parallelFor(0, mesh.vertices.size(), TrackPath::PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t v = begin; v < end; ++v)
+            {
+                allVertices[offset + v] = src[v].Position;
+            }
+        });
+        offset += mesh.vertices.size();
+    }
+}
+
+// Mean triangle edge length over all meshes, 0 for meshes without triangles
+float meanEdgeLength(const Model& trackModel)
+{
+    double sum = 0.0;
+    size_t edges = 0;
+    for (const auto& mesh : trackModel.meshes)
+    {
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            const glm::vec3& a = mesh.vertices[mesh.indices[i]].Position;
+            const glm::vec3& b = mesh.vertices[mesh.indices[i + 1]].Position;
+            const glm::vec3& c = mesh.vertices[mesh.indices[i + 2]].Position;
+            sum += glm::length(b - a) + glm::length(c - b) + glm::length(a - c);
+            edges += 3;
+        }
+    }
+    return edges > 0 ? static_cast<float>(sum / edges) : 0.0f;
+}
+
+} // namespace
+
+void TrackPath::extractFromModel(const Model& trackModel, int numSegments, int verticesPerSegment)
+{
+    // Collect all vertices from all meshes into one contiguous array
+    std::vector<glm::vec3> allVertices;
+    gatherVertices(trackModel, allVertices);
+
+    // The edge length only sizes the automatic detection grid, so skip the pass over the
+    // triangles when the fixed layout fits
+    size_t expected = static_cast<size_t>(numSegments) * static_cast<size_t>(verticesPerSegment);
+    float edgeLength = allVertices.size() < expected ? meanEdgeLength(trackModel) : 0.0f;
+
+    extractFromVertices(allVertices, edgeLength, numSegments, verticesPerSegment);
+}
+
+void TrackPath::extractFromModelAuto(const Model& trackModel)
+{
+    std::vector<glm::vec3> allVertices;
+    gatherVertices(trackModel, allVertices);
+
+    extractFromVerticesAuto(allVertices, meanEdgeLength(trackModel));
+}
@@ -0,0 +1,411 @@
+#include "../Header/trackpath.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+#include <unordered_map>
+
+// Automatic cross-section detection
+//
+// Vertices are binned into a uniform grid. Occupied cells that touch (26-neighbourhood) form a
+// graph that follows the track, and a breadth-first search from a cell at one end of the bounding
+// box gives every cell its hop distance from that seed. Cells at equal distance form a thin shell
+// across the track, so the centroid of each shell is a center line point. On a closed loop every
+// shell has two parts, one on each side of the seed; cells near the seed are split by the track
+// tangent and the rest inherit their side from their BFS parent. Walking one side back towards the
+// seed and then the other side away from it orders the points along the whole track.
+//
+// Everything is linear in the vertex count, and the cell size is at most doubled
+// log2(1024 / 32) times while looking for a connected grid.
+
+namespace
+{
+
+// Vertices binned into one cell of the clustering grid
+struct Cell
+{
+    int x, y, z;
+    double sumX, sumY, sumZ;
+    double sumSq;
+    int count;
+};
+
+// Vertices with the same BFS level and side
+struct Shell
+{
+    double sumX, sumY, sumZ;
+    double sumSq;
+    int count;
+};
+
+// Grid coordinates are offset by one so the neighbours of boundary cells never go negative
+uint64_t packCell(int x, int y, int z)
+{
+    return (static_cast<uint64_t>(x) << 42) | (static_cast<uint64_t>(y) << 21) | static_cast<uint64_t>(z);
+}
+
+glm::vec3 cellCentroid(const Cell& cell)
+{
+    double inv = 1.0 / cell.count;
+    return glm::vec3(static_cast<float>(cell.sumX * inv),
+                     static_cast<float>(cell.sumY * inv),
+                     static_cast<float>(cell.sumZ * inv));
+}
+
+struct ClusterGrid
+{
+    std::vector<Cell> cells;
+    std::unordered_map<uint64_t, int> lookup;
+
+    void build(const std::vector<glm::vec3>& vertices, const glm::vec3& origin, float cellSize)
+    {
+        cells.clear();
+        lookup.clear();
+        lookup.reserve(vertices.size() / 4 + 16);
+
+        float invSize = 1.0f / cellSize;
+        for (const glm::vec3& p : vertices)
+        {
+            glm::vec3 g = (p - origin) * invSize;
+            int x = static_cast<int>(std::floor(g.x)) + 1;
+            int y = static_cast<int>(std::floor(g.y)) + 1;
+            int z = static_cast<int>(std::floor(g.z)) + 1;
+
+            auto inserted = lookup.emplace(packCell(x, y, z), static_cast<int>(cells.size()));
+            if (inserted.second)
+            {
+                cells.push_back(Cell{ x, y, z, 0.0, 0.0, 0.0, 0.0, 0 });
+            }
+
+            Cell& cell = cells[inserted.first->second];
+            cell.sumX += p.x;
+            cell.sumY += p.y;
+            cell.sumZ += p.z;
+            cell.sumSq += static_cast<double>(p.x) * p.x + static_cast<double>(p.y) * p.y +
+                          static_cast<double>(p.z) * p.z;
+            cell.count++;
+        }
+    }
+
+    int find(int x, int y, int z) const
+    {
+        auto it = lookup.find(packCell(x, y, z));
+        return it != lookup.end() ? it->second : -1;
+    }
+};
+
+// Breadth-first search over touching cells; order lists the reached cells level by level
+struct Traversal
+{
+    std::vector<int> level;
+    std::vector<int> parent;
+    std::vector<int> order;
+    size_t reachedVertices;
+};
+
+void traverse(const ClusterGrid& grid, int seed, Traversal& result)
+{
+    size_t numCells = grid.cells.size();
+    result.level.assign(numCells, -1);
+    result.parent.assign(numCells, -1);
+    result.order.clear();
+    result.order.reserve(numCells);
+    result.reachedVertices = 0;
+
+    result.level[seed] = 0;
+    result.order.push_back(seed);
+
+    for (size_t head = 0; head < result.order.size(); ++head)
+    {
+        int current = result.order[head];
+        const Cell& cell = grid.cells[current];
+        result.reachedVertices += cell.count;
+
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dz = -1; dz <= 1; ++dz)
+                {
+                    int neighbour = grid.find(cell.x + dx, cell.y + dy, cell.z + dz);
+                    if (neighbour < 0 || result.level[neighbour] >= 0)
+                    {
+                        continue;
+                    }
+                    result.level[neighbour] = result.level[current] + 1;
+                    result.parent[neighbour] = current;
+                    result.order.push_back(neighbour);
+                }
+            }
+        }
+    }
+}
+
+// Principal axis of the reached cells within maxLevel of the seed, weighted by vertex count.
+// Returns the share of the variance along that axis.
+float principalAxis(const ClusterGrid& grid, const Traversal& traversal, int maxLevel, glm::vec3& axis)
+{
+    double weight = 0.0;
+    double mean[3] = { 0.0, 0.0, 0.0 };
+    for (int idx : traversal.order)
+    {
+        if (traversal.level[idx] > maxLevel) break;
+        const Cell& cell = grid.cells[idx];
+        mean[0] += cell.sumX;
+        mean[1] += cell.sumY;
+        mean[2] += cell.sumZ;
+        weight += cell.count;
+    }
+    for (double& m : mean) m /= weight;
+
+    double cov[3][3] = {};
+    for (int idx : traversal.order)
+    {
+        if (traversal.level[idx] > maxLevel) break;
+        const Cell& cell = grid.cells[idx];
+        glm::vec3 c = cellCentroid(cell);
+        double d[3] = { c.x - mean[0], c.y - mean[1], c.z - mean[2] };
+        for (int r = 0; r < 3; ++r)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                cov[r][k] += d[r] * d[k] * cell.count;
+            }
+        }
+    }
+
+    double trace = cov[0][0] + cov[1][1] + cov[2][2];
+    if (trace <= 0.0)
+    {
+        axis = glm::vec3(1.0f, 0.0f, 0.0f);
+        return 1.0f;
+    }
+
+    // Power iteration, starting from the largest diagonal entry's axis
+    int start = 0;
+    if (cov[1][1] > cov[start][start]) start = 1;
+    if (cov[2][2] > cov[start][start]) start = 2;
+    double v[3] = { 0.0, 0.0, 0.0 };
+    v[start] = 1.0;
+    double lambda = 0.0;
+    for (int iter = 0; iter < 64; ++iter)
+    {
+        double w[3];
+        for (int r = 0; r < 3; ++r)
+        {
+            w[r] = cov[r][0] * v[0] + cov[r][1] * v[1] + cov[r][2] * v[2];
+        }
+        lambda = std::sqrt(w[0] * w[0] + w[1] * w[1] + w[2] * w[2]);
+        if (lambda <= 0.0) break;
+        for (int r = 0; r < 3; ++r) v[r] = w[r] / lambda;
+    }
+
+    axis = glm::vec3(static_cast<float>(v[0]), static_cast<float>(v[1]), static_cast<float>(v[2]));
+    return static_cast<float>(lambda / trace);
+}
+
+// Resample a polyline to count points at equal distances along it;
+// a closed polyline also walks the edge from the last point back to the first
+std::vector<glm::vec3> resamplePolyline(const std::vector<glm::vec3>& points, bool closed, int count)
+{
+    size_t n = points.size();
+    size_t numEdges = closed ? n : n - 1;
+
+    float length = 0.0f;
+    for (size_t e = 0; e < numEdges; ++e)
+    {
+        length += glm::length(points[(e + 1) % n] - points[e]);
+    }
+
+    std::vector<glm::vec3> result;
+    result.reserve(count);
+
+    float step = closed ? length / count : length / (count - 1);
+    float walked = 0.0f;
+    size_t i = 0;
+    for (int k = 0; k < count; ++k)
+    {
+        float target = k * step;
+        float segment = glm::length(points[(i + 1) % n] - points[i]);
+        while (walked + segment < target && i + 1 < numEdges)
+        {
+            walked += segment;
+            ++i;
+            segment = glm::length(points[(i + 1) % n] - points[i]);
+        }
+
+        float f = segment > 0.0f ? glm::clamp((target - walked) / segment, 0.0f, 1.0f) : 0.0f;
+        result.push_back(glm::mix(points[i], points[(i + 1) % n], f));
+    }
+    return result;
+}
+
+} // namespace
+
+bool TrackPath::detectCenterPoints(const std::vector<glm::vec3>& vertices, float cellSize)
+{
+    if (vertices.size() < 4)
+    {
+        return false;
+    }
+
+    glm::vec3 minBounds(FLT_MAX), maxBounds(-FLT_MAX);
+    for (const glm::vec3& p : vertices)
+    {
+        minBounds = glm::min(minBounds, p);
+        maxBounds = glm::max(maxBounds, p);
+    }
+    glm::vec3 extent = maxBounds - minBounds;
+    float diagonal = glm::length(extent);
+    if (!(diagonal > 0.0f))
+    {
+        return false;
+    }
+
+    // Seed at the low end of the longest bounding box axis, which is always on the track
+    int axis = 0;
+    if (extent.y > extent[axis]) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    // The cells must be large enough to bridge gaps between rails and ties, so grow them until the
+    // whole mesh is one connected piece
+    float h = std::max(cellSize, diagonal / 1024.0f);
+    ClusterGrid grid;
+    Traversal traversal;
+    int seed = 0;
+    for (;;)
+    {
+        grid.build(vertices, minBounds, h);
+
+        seed = 0;
+        for (int c = 1; c < static_cast<int>(grid.cells.size()); ++c)
+        {
+            const Cell& a = grid.cells[c];
+            const Cell& b = grid.cells[seed];
+            int ca = axis == 0 ? a.x : (axis == 1 ? a.y : a.z);
+            int cb = axis == 0 ? b.x : (axis == 1 ? b.y : b.z);
+            if (ca < cb || (ca == cb && a.count > b.count)) seed = c;
+        }
+
+        traverse(grid, seed, traversal);
+        if (traversal.reachedVertices == vertices.size())
+        {
+            break;
+        }
+        if (h * 2.0f > diagonal / 32.0f)
+        {
+            std::cerr << "TrackPath: Track mesh is not connected, using the part reached from the seed ("
+                      << traversal.reachedVertices << " of " << vertices.size() << " vertices)" << std::endl;
+            break;
+        }
+        h *= 2.0f;
+    }
+
+    int maxLevel = traversal.level[traversal.order.back()];
+    std::cout << "TrackPath: Clustered " << vertices.size() << " vertices into " << grid.cells.size()
+              << " cells of size " << h << ", " << (maxLevel + 1) << " levels" << std::endl;
+
+    if (maxLevel < 2)
+    {
+        return false;
+    }
+
+    // Track tangent at the seed: grow the neighbourhood until it is clearly elongated
+    glm::vec3 tangent(1.0f, 0.0f, 0.0f);
+    int splitLevel = 2;
+    for (;;)
+    {
+        float share = principalAxis(grid, traversal, splitLevel, tangent);
+        if (share > 0.8f || splitLevel * 4 >= maxLevel)
+        {
+            break;
+        }
+        splitLevel *= 2;
+    }
+
+    // Side of the seed each cell lies on; BFS order visits parents before children
+    glm::vec3 seedPos = cellCentroid(grid.cells[seed]);
+    std::vector<unsigned char> side(grid.cells.size(), 0);
+    for (int idx : traversal.order)
+    {
+        if (traversal.level[idx] <= splitLevel)
+        {
+            side[idx] = glm::dot(cellCentroid(grid.cells[idx]) - seedPos, tangent) < 0.0f ? 1 : 0;
+        }
+        else
+        {
+            side[idx] = side[traversal.parent[idx]];
+        }
+    }
+
+    // Accumulate the vertices of each (level, side) shell
+    std::vector<Shell> shells(static_cast<size_t>(maxLevel + 1) * 2, Shell{ 0.0, 0.0, 0.0, 0.0, 0 });
+    for (int idx : traversal.order)
+    {
+        const Cell& cell = grid.cells[idx];
+        Shell& shell = shells[traversal.level[idx] * 2 + side[idx]];
+        shell.sumX += cell.sumX;
+        shell.sumY += cell.sumY;
+        shell.sumZ += cell.sumZ;
+        shell.sumSq += cell.sumSq;
+        shell.count += cell.count;
+    }
+
+    // Shells near the seed and where the two fronts meet cover only part of a cross-section
+    // (e.g. one rail), so their centroids are off-center. Skip shells well below the typical size.
+    std::vector<int> counts;
+    counts.reserve(shells.size());
+    for (const Shell& shell : shells)
+    {
+        if (shell.count > 0) counts.push_back(shell.count);
+    }
+    std::nth_element(counts.begin(), counts.begin() + counts.size() / 2, counts.end());
+    int minCount = static_cast<int>(counts[counts.size() / 2] * 0.6f);
+
+    // One side walked back to the seed, then the other side away from it
+    std::vector<glm::vec3> ordered;
+    ordered.reserve(shells.size());
+    double radiusSum = 0.0;
+    auto addShell = [&](const Shell& shell) {
+        if (shell.count == 0 || shell.count < minCount) return;
+        double inv = 1.0 / shell.count;
+        double mx = shell.sumX * inv, my = shell.sumY * inv, mz = shell.sumZ * inv;
+        double variance = shell.sumSq * inv - (mx * mx + my * my + mz * mz);
+        radiusSum += std::sqrt(std::max(variance, 0.0));
+        ordered.push_back(glm::vec3(static_cast<float>(mx), static_cast<float>(my), static_cast<float>(mz)));
+    };
+    for (int level = maxLevel; level >= 0; --level)
+    {
+        addShell(shells[level * 2]);
+    }
+    for (int level = 0; level <= maxLevel; ++level)
+    {
+        addShell(shells[level * 2 + 1]);
+    }
+
+    if (ordered.size() < 4)
+    {
+        return false;
+    }
+
+    // Resample at roughly one point per cross-section width, like a hand-authored ring layout
+    float length = 0.0f;
+    for (size_t i = 0; i + 1 < ordered.size(); ++i)
+    {
+        length += glm::length(ordered[i + 1] - ordered[i]);
+    }
+    float radius = static_cast<float>(radiusSum / ordered.size());
+    float spacing = std::max(h, radius);
+    int count = std::max(4, static_cast<int>(length / spacing + 0.5f));
+
+    // If the two ends of the walk don't meet the track is open; don't resample across the gap
+    bool closed = glm::length(ordered.back() - ordered.front()) < 4.0f * spacing;
+    if (!closed)
+    {
+        std::cout << "TrackPath: Track mesh is open, the path will be closed with a straight segment" << std::endl;
+    }
+
+    centerPoints = resamplePolyline(ordered, closed, count);
+    return true;
+}
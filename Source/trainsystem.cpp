@@ -0,0 +1,224 @@
+#include "../Header/trainsystem.hpp"
+#include "../Header/dynamics.hpp"
+#include "../Header/parallel.hpp"
+#include "../Header/threadpool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+TrainSystem::TrainSystem()
+    : framesDirty(false), dynamics(nullptr), arcade(), pool(nullptr)
+{
+}
+
+TrainSystem::~TrainSystem() = default;
+
+size_t TrainSystem::addTrain(float t, State state, float v)
+{
+    states.push_back(state);
+    trackT.push_back(t);
+    velocity.push_back(v);
+    acceleration.push_back(0.0f);
+    distances.push_back(0.0f);
+    framesDirty = true;
+    return states.size() - 1;
+}
+
+void TrainSystem::clear()
+{
+    states.clear();
+    trackT.clear();
+    velocity.clear();
+    acceleration.clear();
+    distances.clear();
+    frames.resize(0);
+    framesDirty = false;
+}
+
+void TrainSystem::step(const TrackPath& path, float deltaTime, bool parallel)
+{
+    size_t n = size();
+    if (n == 0 || !path.isInitialized())
+    {
+        return;
+    }
+
+    // Trains added or moved since the last step need frames at their current positions,
+    // since the slope for this step is read from them
+    if (framesDirty)
+    {
+        float length = path.getLength();
+        for (size_t i = 0; i < n; ++i)
+        {
+            distances[i] = trackT[i] * length;
+        }
+        path.evaluateFramesAtDistance(distances.data(), n, frames);
+        framesDirty = false;
+    }
+
+    if (parallel)
+    {
+        forEachRange(PARALLEL_GRAIN, [&](size_t begin, size_t end)
+        {
+            stepRange(path, deltaTime, begin, end);
+        });
+    }
+    else
+    {
+        stepRange(path, deltaTime, 0, n);
+    }
+}
+
+void TrainSystem::forEachRange(size_t minChunk, const std::function<void(size_t, size_t)>& fn)
+{
+    size_t n = size();
+    if (n < 2 * minChunk)
+    {
+        fn(0, n);  // Too few trains to be worth a hand-off
+        return;
+    }
+    if (!pool)
+    {
+        ownPool.reset(new WorkStealingPool());
+        pool = ownPool.get();
+    }
+    pool->parallelFor(0, n, minChunk, fn);
+}
+
+void TrainSystem::stepRange(const TrackPath& path, float deltaTime, size_t begin, size_t end)
+{
+    float length = path.getLength();
+    float lengthMetres = dynamics ? dynamics->getTrackLength(path) : 0.0f;
+    const float* slopes = frames.forwardY.data();
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        State state = states[i];
+        if (state == State::STOPPED)
+        {
+            continue;
+        }
+
+        float v = velocity[i];
+        float t = trackT[i];
+
+        if (dynamics && (state == State::STARTING || state == State::RUNNING))
+        {
+            DynamicsState physical;
+            physical.distance = static_cast<double>(t) * lengthMetres;
+            physical.speed = v * lengthMetres;
+            physical.work = 0.0;
+            physical.chainSpeed = state == State::STARTING ? arcade.cruiseSpeed * lengthMetres : 0.0f;
+
+            dynamics->step(path, physical, deltaTime);
+
+            v = physical.speed / lengthMetres;
+            t = static_cast<float>(physical.distance / lengthMetres);
+            if (state == State::STARTING && v >= arcade.cruiseSpeed * 0.999f)
+            {
+                state = State::RUNNING;
+            }
+        }
+        else
+        {
+            if (state == State::STARTING)
+            {
+                v += arcade.chainLiftAccel * deltaTime;
+                if (v >= arcade.cruiseSpeed)
+                {
+                    v = arcade.cruiseSpeed;
+                    state = State::RUNNING;
+                }
+            }
+            else if (state == State::RUNNING)
+            {
+                // Slope from the frame at the start of the step
+                float accel = -arcade.gravityEffect * slopes[i] - arcade.friction * v;
+                v = glm::clamp(v + accel * deltaTime, arcade.minVelocity, arcade.maxVelocity);
+            }
+            else if (state == State::DECELERATING)
+            {
+                v += acceleration[i] * deltaTime;
+                if (v <= 0.0f)
+                {
+                    v = 0.0f;
+                    state = State::STOPPED;
+                }
+            }
+            else if (state == State::BRAKING)
+            {
+                v += acceleration[i] * deltaTime;
+                if (v <= 0.0f)
+                {
+                    v = 0.0f;
+                    state = State::HOLDING;
+                }
+            }
+            else if (state == State::HOLDING)
+            {
+                v = 0.0f;
+            }
+
+            t += v * deltaTime;
+        }
+
+        if (t >= 1.0f)
+        {
+            t -= 1.0f;
+        }
+        else if (t < 0.0f)
+        {
+            t += 1.0f;
+        }
+
+        states[i] = state;
+        velocity[i] = v;
+        trackT[i] = t;
+        distances[i] = t * length;
+    }
+
+    // Frames at the new positions, which also give the slope for the next step
+    path.evaluateFramesAtDistance(distances.data(), begin, end, frames);
+}
+
+void benchmarkTrainSystem(const TrackPath& path)
+{
+    if (!path.isInitialized())
+    {
+        return;
+    }
+
+    const int steps = 240;
+    const float dt = 1.0f / 240.0f;
+    const size_t counts[] = { 1000, 10000, 100000 };
+
+    WorkStealingPool pool;
+    std::cout << "TrainSystem: " << steps << " steps per run, " << pool.size() << " threads" << std::endl;
+    for (size_t count : counts)
+    {
+        double nsPerTrainStep[2];
+        for (int parallel = 0; parallel < 2; ++parallel)
+        {
+            TrainSystem trains;
+            trains.setPool(&pool);
+            for (size_t i = 0; i < count; ++i)
+            {
+                trains.addTrain(static_cast<float>(i) / count, TrainSystem::State::RUNNING, 0.05f);
+            }
+            trains.step(path, dt, parallel != 0);  // Warm up and build the initial frames
+
+            auto start = std::chrono::steady_clock::now();
+            for (int s = 0; s < steps; ++s)
+            {
+                trains.step(path, dt, parallel != 0);
+            }
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            nsPerTrainStep[parallel] = elapsed.count() / (static_cast<double>(count) * steps);
+        }
+
+        std::cout << "  " << count << " trains: " << nsPerTrainStep[0] << " ns/train-step on one thread, "
+                  << nsPerTrainStep[1] << " ns/train-step parallel (x"
+                  << nsPerTrainStep[0] / nsPerTrainStep[1] << ")" << std::endl;
+    }
+}
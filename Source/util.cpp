@@ -24,41 +24,68 @@ void limitFPS(double& lastTimeForRefresh, int targetFPS)
 }
 
 unsigned int loadTexture(const char* path)
+{
+    ImageData image;
+    decodeImage(path, image);
+    return uploadTexture(image, path);
+}
+
+bool decodeImage(const char* path, ImageData& image, int channels, bool flip)
+{
+    freeImage(image);
+
+    // Per thread, so decodes on different threads can flip differently
+    stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
+
+    image.pixels = stbi_load(path, &image.width, &image.height, &image.fileChannels, channels);
+    image.channels = channels > 0 ? channels : image.fileChannels;
+    return image.pixels != nullptr;
+}
+
+unsigned int uploadTexture(ImageData& image, const char* path, bool repeat)
 {
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
-    // Flip image vertically to match OpenGL's coordinate system
-    stbi_set_flip_vertically_on_load(true);
-
-    int width, height, nrChannels;
-    // Force load as RGBA to handle any color space issues
-    unsigned char* data = stbi_load(path, &width, &height, &nrChannels, 4);
-    if (data)
+    if (image.pixels)
     {
-        std::cout << "Loaded texture: " << path << " (" << width << "x" << height
-                  << ", original " << nrChannels << " channels, converted to RGBA)" << std::endl;
+        std::cout << "Loaded texture: " << path << " (" << image.width << "x" << image.height
+                  << ", original " << image.fileChannels << " channels, uploaded with " << image.channels << ")" << std::endl;
+
+        GLenum format = GL_RGBA;
+        if (image.channels == 1)
+            format = GL_RED;
+        else if (image.channels == 3)
+            format = GL_RGB;
 
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels);
         glGenerateMipmap(GL_TEXTURE_2D);
 
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        GLint wrap = repeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
     }
     else
     {
         std::cout << "Failed to load texture: " << path << std::endl;
-        stbi_image_free(data);
     }
 
+    freeImage(image);
     return textureID;
 }
 
+void freeImage(ImageData& image)
+{
+    if (image.pixels)
+    {
+        stbi_image_free(image.pixels);
+    }
+    image = ImageData();
+}
+
 void setupOverlayQuad(unsigned int& VAO, unsigned int& VBO)
 {
     // Overlay quad in bottom-right corner (normalized device coordinates)
@@ -1,23 +1,12 @@
 #include "../Header/wagon.hpp"
 #include "../Header/shader.hpp"
-#include "../Header/trackpath.hpp"
-#include "../Header/util.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 
 Wagon::Wagon(float width, float height, float depth)
-    : VAO(0), VBO(0), vertexCount(0),
-      width(width), height(height), depth(depth),
-      position(0.0f), color(0.2f, 0.9f, 0.2f),
-      forwardDir(0.0f, 0.0f, 1.0f),
-      upDir(0.0f, 1.0f, 0.0f),
-      rightDir(1.0f, 0.0f, 0.0f),
-      trackT(0.0f),
-      heightOffset(1.0f),
-      rideState(RideState::STOPPED),
-      velocity(0.0f),
-      acceleration(0.0f),
-      textureID(0),
-      seatTextureID(0)
+    : WagonState(width, height, depth),
+      VAO(0), VBO(0), vertexCount(0),
+      seatVAO(0), seatVBO(0),
+      color(0.2f, 0.9f, 0.2f)
 {
 }
 
@@ -28,171 +17,34 @@ Wagon::~Wagon()
         glDeleteVertexArrays(1, &VAO);
         glDeleteBuffers(1, &VBO);
     }
-    if (textureID != 0)
+    if (seatVAO != 0)
     {
-        glDeleteTextures(1, &textureID);
-    }
-    if (seatTextureID != 0)
-    {
-        glDeleteTextures(1, &seatTextureID);
+        glDeleteVertexArrays(1, &seatVAO);
+        glDeleteBuffers(1, &seatVBO);
     }
 }
 
-void Wagon::init()
+void Wagon::init(ResourceManager& resources)
 {
     setupMesh();
     setupSeatMesh();
-    textureID = loadTexture("res/textures/wagon_texture.jpg");
-    seatTextureID = loadTexture("res/textures/seat_texture.jpg");
-}
-
-void Wagon::setPosition(const glm::vec3& pos)
-{
-    position = pos;
-}
-
-void Wagon::setOrientation(const glm::vec3& forward, const glm::vec3& up)
-{
-    forwardDir = glm::normalize(forward);
-    upDir = glm::normalize(up);
-    rightDir = glm::normalize(glm::cross(forwardDir, upDir));
-    // Recalculate up to ensure orthogonality
-    upDir = glm::normalize(glm::cross(rightDir, forwardDir));
-}
-
-void Wagon::updateFromTrackPath(const TrackPath& path, float t)
-{
-    if (!path.isInitialized())
+    // Without a texture the wagon and seats are drawn in their material color
+    texture = resources.loadTexture("res/textures/wagon_texture.jpg");
+    if (texture)
     {
-        return;
+        texture->upload();
     }
-
-    trackT = t;
-
-    // Get position from track and offset upward
-    glm::vec3 trackPos = path.getPosition(t);
-    glm::vec3 up = path.getUp(t);
-
-    // Position wagon above the track center
-    position = trackPos + up * heightOffset;
-
-    // Set orientation to follow track
-    glm::vec3 forward = path.getForward(t);
-    setOrientation(forward, up);
-}
-
-void Wagon::startRide()
-{
-    if (rideState == RideState::STOPPED)
+    seatTexture = resources.loadTexture("res/textures/seat_texture.jpg");
+    if (seatTexture)
     {
-        rideState = RideState::STARTING;
-        velocity = 0.0f;
+        seatTexture->upload();
     }
 }
 
-void Wagon::stopRide()
+void Wagon::releaseTextures()
 {
-    rideState = RideState::STOPPED;
-    velocity = 0.0f;
-}
-
-void Wagon::stop()
-{
-    rideState = RideState::STOPPED;
-    velocity = 0.0f;
-    acceleration = 0.0f;
-}
-
-void Wagon::setConstantVelocity(float vel)
-{
-    rideState = RideState::CONSTANT;
-    velocity = vel;
-    acceleration = 0.0f;
-}
-
-void Wagon::setDeceleration(float decel)
-{
-    rideState = RideState::DECELERATING;
-    acceleration = decel;
-}
-
-void Wagon::updatePhysics(const TrackPath& path, float deltaTime)
-{
-    if (rideState == RideState::STOPPED || !path.isInitialized())
-    {
-        return;
-    }
-
-    if (rideState == RideState::STARTING)
-    {
-        // Chain lift phase: accelerate steadily until reaching cruise speed
-        velocity += CHAIN_LIFT_ACCEL * deltaTime;
-
-        if (velocity >= CRUISE_SPEED)
-        {
-            velocity = CRUISE_SPEED;
-            rideState = RideState::RUNNING;
-        }
-    }
-    else if (rideState == RideState::RUNNING)
-    {
-        // Get forward direction to calculate slope
-        glm::vec3 forward = path.getForward(trackT);
-
-        // Slope is the Y component of the forward direction
-        // Positive = going uphill, Negative = going downhill
-        float slope = forward.y;
-
-        // Apply gravity effect: decelerate uphill, accelerate downhill
-        float accel = -GRAVITY_EFFECT * slope;
-
-        // Apply friction (always opposes motion)
-        accel -= FRICTION * velocity;
-
-        // Update velocity
-        velocity += accel * deltaTime;
-
-        // Clamp velocity to reasonable bounds
-        if (velocity < MIN_VELOCITY)
-        {
-            velocity = MIN_VELOCITY;
-        }
-        if (velocity > MAX_VELOCITY)
-        {
-            velocity = MAX_VELOCITY;
-        }
-    }
-    else if (rideState == RideState::DECELERATING)
-    {
-        // Apply constant deceleration (acceleration is negative)
-        velocity += acceleration * deltaTime;
-
-        // Don't go below zero
-        if (velocity < 0.0f)
-        {
-            velocity = 0.0f;
-        }
-    }
-    else if (rideState == RideState::CONSTANT)
-    {
-        // Velocity stays constant (already set)
-    }
-
-    // Update track position
-    trackT += velocity * deltaTime;
-
-    // Handle wrap-around for track parameter
-    if (trackT >= 1.0f)
-    {
-        trackT -= 1.0f;
-    }
-    else if (trackT < 0.0f)
-    {
-        trackT += 1.0f;
-    }
-
-    // Update wagon transform
-    updateFromTrackPath(path, trackT);
+    texture.reset();
+    seatTexture.reset();
 }
 
 void Wagon::setupMesh()
@@ -282,38 +134,43 @@ void Wagon::draw(Shader& shader)
 {
     shader.use();
 
-    // Create model matrix with position and orientation
-    // The wagon's local Z axis points forward along the track
-    // Build rotation matrix from orientation vectors
-    glm::mat4 rotation(1.0f);
-    rotation[0] = glm::vec4(rightDir, 0.0f);    // X axis = right
-    rotation[1] = glm::vec4(upDir, 0.0f);       // Y axis = up
-    rotation[2] = glm::vec4(forwardDir, 0.0f);  // Z axis = forward
-    rotation[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
-
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, position);
-    model = model * rotation;
-
-    shader.setMat4("uM", model);
-
-    // Bind wagon texture
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    shader.setInt("uDiffMap1", 0);
-    shader.setBool("uUseTexture", true);
-
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-
-    // Draw Seats with texture
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, seatTextureID);
-    shader.setInt("uDiffMap1", 0);
-    shader.setBool("uUseTexture", true);
-    glBindVertexArray(seatVAO);
-    for (int i = 0; i < 8; ++i) {
-        drawSingleSeat(shader, model, i);
+    for (int c = 0; c < getCarCount(); ++c)
+    {
+        const CarPose& car = getCarPose(c);
+
+        // Create model matrix with position and orientation
+        // The car's local Z axis points forward along the track
+        // Build rotation matrix from orientation vectors
+        glm::mat4 rotation(1.0f);
+        rotation[0] = glm::vec4(car.right, 0.0f);    // X axis = right
+        rotation[1] = glm::vec4(car.up, 0.0f);       // Y axis = up
+        rotation[2] = glm::vec4(car.forward, 0.0f);  // Z axis = forward
+        rotation[3] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, car.position);
+        model = model * rotation;
+
+        shader.setMat4("uM", model);
+
+        // Bind wagon texture
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture ? texture->id : 0);
+        shader.setInt("uDiffMap1", 0);
+        shader.setBool("uUseTexture", texture != nullptr);
+
+        glBindVertexArray(VAO);
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+
+        // Draw Seats with texture
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, seatTexture ? seatTexture->id : 0);
+        shader.setInt("uDiffMap1", 0);
+        shader.setBool("uUseTexture", seatTexture != nullptr);
+        glBindVertexArray(seatVAO);
+        for (int i = 0; i < SEATS_PER_CAR; ++i) {
+            drawSingleSeat(shader, model, i);
+        }
     }
     glBindVertexArray(0);
 }
@@ -418,19 +275,3 @@ void Wagon::drawSingleSeat(Shader& shader, const glm::mat4& wagonModel, int inde
     shader.setMat4("uM", backModel);
     glDrawArrays(GL_TRIANGLES, 0, 36);
 }
-
-Wagon::SeatTransform Wagon::getSeatWorldTransform(int index) const {
-    int row = index / 2;
-    int col = index % 2;
-
-    // Local offset (matches the draw logic)
-    float xOffset = (col == 0) ? -width * 0.25f : width * 0.25f;
-    float zOffset = depth * 0.35f - (row * (depth * 0.23f));
-    float yOffset = -height * 0.2f; // Offset slightly up so they sit ON the cushion
-
-    // Combine local offset with wagon orientation
-    // Position = WagonPos + (Right * xOffset) + (Up * yOffset) + (Forward * zOffset)
-    glm::vec3 worldPos = position + (rightDir * xOffset) + (upDir * yOffset) + (forwardDir * zOffset);
-
-    return { worldPos, forwardDir, upDir };
-}
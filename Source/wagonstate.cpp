@@ -0,0 +1,343 @@
+#include "../Header/wagonstate.hpp"
+#include "../Header/dynamics.hpp"
+#include "../Header/mappedfile.hpp"
+#include "../Header/trackpath.hpp"
+
+WagonState::WagonState(float width, float height, float depth)
+    : width(width), height(height), depth(depth),
+      cars(1, CarPose{ glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) }),
+      carSpacing(depth + 1.0f),
+      trackT(0.0f),
+      previousT(0.0f),
+      heightOffset(1.0f),
+      rideState(RideState::STOPPED),
+      velocity(0.0f),
+      acceleration(0.0f),
+      dynamics(nullptr),
+      arcade(),
+      watchedSpeed(-1.0f),
+      lapMarker(-1.0f),
+      stationMarker(-1.0f)
+{
+}
+
+void WagonState::setPosition(const glm::vec3& pos)
+{
+    cars[0].position = pos;
+}
+
+void WagonState::setOrientation(const glm::vec3& forward, const glm::vec3& up)
+{
+    CarPose& lead = cars[0];
+    lead.forward = glm::normalize(forward);
+    lead.up = glm::normalize(up);
+    lead.right = glm::normalize(glm::cross(lead.forward, lead.up));
+    // Recalculate up to ensure orthogonality
+    lead.up = glm::normalize(glm::cross(lead.right, lead.forward));
+}
+
+void WagonState::setCarCount(int count, float gap)
+{
+    cars.resize(count > 0 ? count : 1, cars[0]);
+    carSpacing = depth + gap;
+}
+
+void WagonState::updateFromTrackPath(const TrackPath& path, float t)
+{
+    if (!path.isInitialized())
+    {
+        return;
+    }
+
+    trackT = t;
+    previousT = t;
+    applyTrackPose(path, t);
+}
+
+void WagonState::interpolate(const TrackPath& path, float alpha)
+{
+    if (!path.isInitialized())
+    {
+        return;
+    }
+
+    // Take the short way round when the last step wrapped past the end of the track
+    float delta = trackT - previousT;
+    if (delta > 0.5f)
+    {
+        delta -= 1.0f;
+    }
+    else if (delta < -0.5f)
+    {
+        delta += 1.0f;
+    }
+
+    float t = previousT + delta * glm::clamp(alpha, 0.0f, 1.0f);
+    if (t >= 1.0f)
+    {
+        t -= 1.0f;
+    }
+    else if (t < 0.0f)
+    {
+        t += 1.0f;
+    }
+
+    applyTrackPose(path, t);
+}
+
+void WagonState::evaluateCarFrames(const TrackPath& path, float t)
+{
+    // t is a fraction of the track length, so look the cars up by distance
+    float length = path.getLength();
+    size_t count = cars.size();
+    carDistances.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        float distance = t * length - static_cast<float>(i) * carSpacing;
+        carDistances[i] = distance < 0.0f ? distance + length : distance;
+    }
+    path.evaluateFramesAtDistance(carDistances.data(), count, carFrames);
+}
+
+float WagonState::averageSlope(const TrackPath& path, float t)
+{
+    if (cars.size() == 1)
+    {
+        return path.getForwardAtDistance(t * path.getLength()).y;
+    }
+
+    evaluateCarFrames(path, t);
+    float sum = 0.0f;
+    for (size_t i = 0; i < cars.size(); ++i)
+    {
+        sum += carFrames.forwardY[i];
+    }
+    return sum / static_cast<float>(cars.size());
+}
+
+void WagonState::applyTrackPose(const TrackPath& path, float t)
+{
+    evaluateCarFrames(path, t);
+    for (size_t i = 0; i < cars.size(); ++i)
+    {
+        CarPose& car = cars[i];
+        car.forward = glm::vec3(carFrames.forwardX[i], carFrames.forwardY[i], carFrames.forwardZ[i]);
+        car.up = glm::vec3(carFrames.upX[i], carFrames.upY[i], carFrames.upZ[i]);
+        car.right = glm::vec3(carFrames.rightX[i], carFrames.rightY[i], carFrames.rightZ[i]);
+
+        // Position each car above the track center; the frame is already orthonormal
+        car.position = glm::vec3(carFrames.posX[i], carFrames.posY[i], carFrames.posZ[i]) + car.up * heightOffset;
+    }
+}
+
+void WagonState::startRide()
+{
+    if (rideState == RideState::STOPPED)
+    {
+        rideState = RideState::STARTING;
+        velocity = 0.0f;
+    }
+}
+
+void WagonState::stopRide()
+{
+    rideState = RideState::STOPPED;
+    velocity = 0.0f;
+}
+
+void WagonState::stop()
+{
+    rideState = RideState::STOPPED;
+    velocity = 0.0f;
+    acceleration = 0.0f;
+}
+
+void WagonState::setConstantVelocity(float vel)
+{
+    rideState = RideState::CONSTANT;
+    velocity = vel;
+    acceleration = 0.0f;
+}
+
+void WagonState::setDeceleration(float decel)
+{
+    rideState = RideState::DECELERATING;
+    acceleration = decel;
+}
+
+void WagonState::updatePhysics(const TrackPath& path, float deltaTime)
+{
+    previousT = trackT;
+
+    if (rideState == RideState::STOPPED || !path.isInitialized())
+    {
+        return;
+    }
+
+    bool wasDecelerating = rideState == RideState::DECELERATING;
+    advance(path, deltaTime);
+
+    if (watchedSpeed >= 0.0f && velocity >= watchedSpeed)
+    {
+        watchedSpeed = -1.0f;
+        events.push(RideEvent::SPEED_REACHED);
+    }
+    if (wasDecelerating && rideState == RideState::STOPPED)
+    {
+        events.push(RideEvent::STOPPED);
+    }
+    if (lapMarker >= 0.0f && velocity > 0.0f && crossed(lapMarker, true))
+    {
+        events.push(RideEvent::LAP_COMPLETED);
+    }
+    if (stationMarker >= 0.0f && velocity != 0.0f && crossed(stationMarker, velocity > 0.0f))
+    {
+        events.push(RideEvent::STATION_REACHED);
+    }
+}
+
+bool WagonState::crossed(float marker, bool forward) const
+{
+    // Distances along the direction of travel, wrapped into the track: the marker must be
+    // ahead of where the step began and no further than the step went
+    float toMarker = forward ? marker - previousT : previousT - marker;
+    if (toMarker <= 0.0f)
+    {
+        toMarker += 1.0f;
+    }
+    float moved = forward ? trackT - previousT : previousT - trackT;
+    if (moved < 0.0f)
+    {
+        moved += 1.0f;
+    }
+    return toMarker <= moved;
+}
+
+void WagonState::advance(const TrackPath& path, float deltaTime)
+{
+
+    if (dynamics && (rideState == RideState::STARTING || rideState == RideState::RUNNING))
+    {
+        // Physical model in metres and seconds; the chain pulls to the same cruise speed as the arcade lift
+        float lengthMetres = dynamics->getTrackLength(path);
+        DynamicsState state;
+        state.distance = static_cast<double>(trackT) * lengthMetres;
+        state.speed = velocity * lengthMetres;
+        state.work = 0.0;
+        state.chainSpeed = rideState == RideState::STARTING ? arcade.cruiseSpeed * lengthMetres : 0.0f;
+
+        dynamics->step(path, state, deltaTime);
+
+        velocity = state.speed / lengthMetres;
+        trackT = static_cast<float>(state.distance / lengthMetres);
+        if (trackT >= 1.0f)
+        {
+            trackT -= 1.0f;
+        }
+        if (rideState == RideState::STARTING && velocity >= arcade.cruiseSpeed * 0.999f)
+        {
+            rideState = RideState::RUNNING;
+        }
+        return;
+    }
+
+    if (rideState == RideState::STARTING)
+    {
+        // Chain lift phase: accelerate steadily until reaching cruise speed
+        velocity += arcade.chainLiftAccel * deltaTime;
+
+        if (velocity >= arcade.cruiseSpeed)
+        {
+            velocity = arcade.cruiseSpeed;
+            rideState = RideState::RUNNING;
+        }
+    }
+    else if (rideState == RideState::RUNNING)
+    {
+        // Slope is the Y component of the forward direction, averaged over the train so the
+        // cars still climbing hold back the ones already over a crest
+        // Positive = going uphill, Negative = going downhill
+        float slope = averageSlope(path, trackT);
+
+        // Apply gravity effect: decelerate uphill, accelerate downhill
+        float accel = -arcade.gravityEffect * slope;
+
+        // Apply friction (always opposes motion)
+        accel -= arcade.friction * velocity;
+
+        // Update velocity
+        velocity += accel * deltaTime;
+
+        // Clamp velocity to reasonable bounds
+        if (velocity < arcade.minVelocity)
+        {
+            velocity = arcade.minVelocity;
+        }
+        if (velocity > arcade.maxVelocity)
+        {
+            velocity = arcade.maxVelocity;
+        }
+    }
+    else if (rideState == RideState::DECELERATING)
+    {
+        // Apply constant deceleration (acceleration is negative)
+        velocity += acceleration * deltaTime;
+
+        // Don't go below zero; at rest the slowdown is over
+        if (velocity <= 0.0f)
+        {
+            velocity = 0.0f;
+            rideState = RideState::STOPPED;
+        }
+    }
+    else if (rideState == RideState::CONSTANT)
+    {
+        // Velocity stays constant (already set)
+    }
+
+    // Update track position
+    trackT += velocity * deltaTime;
+
+    // Handle wrap-around for track parameter
+    if (trackT >= 1.0f)
+    {
+        trackT -= 1.0f;
+    }
+    else if (trackT < 0.0f)
+    {
+        trackT += 1.0f;
+    }
+}
+
+WagonState::SeatTransform WagonState::getSeatWorldTransform(int index) const {
+    int carIndex = glm::clamp(index / SEATS_PER_CAR, 0, static_cast<int>(cars.size()) - 1);
+    const CarPose& car = cars[carIndex];
+    index %= SEATS_PER_CAR;
+
+    int row = index / 2;
+    int col = index % 2;
+
+    // Local offset (matches the draw logic)
+    float xOffset = (col == 0) ? -width * 0.25f : width * 0.25f;
+    float zOffset = depth * 0.35f - (row * (depth * 0.23f));
+    float yOffset = -height * 0.2f; // Offset slightly up so they sit ON the cushion
+
+    // Combine local offset with the car's orientation
+    // Position = CarPos + (Right * xOffset) + (Up * yOffset) + (Forward * zOffset)
+    glm::vec3 worldPos = car.position + (car.right * xOffset) + (car.up * yOffset) + (car.forward * zOffset);
+
+    return { worldPos, car.forward, car.up, car.right };
+}
+
+uint64_t WagonState::hashState(uint64_t seed) const
+{
+    float motion[7] = { trackT, previousT, velocity, acceleration, watchedSpeed, lapMarker, stationMarker };
+    uint8_t mode[2] = { static_cast<uint8_t>(rideState), static_cast<uint8_t>(dynamics != nullptr) };
+    uint64_t hash = hashBytes(motion, sizeof(motion), seed);
+    hash = hashBytes(mode, sizeof(mode), hash);
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        hash = hashBytes(&events.at(i), sizeof(RideEvent), hash);
+    }
+    return hash;
+}